@@ -0,0 +1,92 @@
+#include<string.h>
+
+#include "bank.h"
+#include "solver.h"
+
+static uint32_t get32( const uint8_t *p ) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put32( uint8_t *p, uint32_t n ) {
+  p[0] = n;
+  p[1] = n >> 8;
+  p[2] = n >> 16;
+  p[3] = n >> 24;
+}
+
+bool bank_read_header( const uint8_t *bytes, bank_header *h ) {
+  if( memcmp(bytes, "SDKB", 4) != 0 ) { return false; }
+  if(bytes[4] != BANK_VERSION || bytes[5] != BANK_LEVELS ||
+     bytes[6] != BANK_GRADES || bytes[7] != BANK_RECORD) { return false; }
+
+  const uint8_t *p = bytes + 8;
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    for( int g=0; g<BANK_GRADES; ++g ) {
+      h->index[l][g].first = get32(p);
+      h->index[l][g].count = get32(p + 4);
+      p += 8;
+    }
+  }
+  return true;
+}
+
+void bank_write_header( const bank_header *h, uint8_t *bytes ) {
+  memcpy(bytes, "SDKB", 4);
+  bytes[4] = BANK_VERSION;
+  bytes[5] = BANK_LEVELS;
+  bytes[6] = BANK_GRADES;
+  bytes[7] = BANK_RECORD;
+
+  uint8_t *p = bytes + 8;
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    for( int g=0; g<BANK_GRADES; ++g ) {
+      put32(p, h->index[l][g].first);
+      put32(p + 4, h->index[l][g].count);
+      p += 8;
+    }
+  }
+}
+
+void bank_read_record( const uint8_t *bytes, board *soln ) {
+  memcpy(soln->value, bytes, sizeof(soln->value));
+  memcpy(soln->fixed, bytes + sizeof(soln->value), sizeof(soln->fixed));
+}
+
+void bank_write_record( const board *soln, uint8_t *bytes ) {
+  memcpy(bytes, soln->value, sizeof(soln->value));
+  memcpy(bytes + sizeof(soln->value), soln->fixed, sizeof(soln->fixed));
+}
+
+uint32_t bank_count( const bank_header *h, int level ) {
+  uint32_t n = 0;
+  for( int g=0; g<BANK_GRADES; ++g ) { n += h->index[level][g].count; }
+  return n;
+}
+
+bool bank_pick( const bank_header *h, int level, rng_state *r, uint32_t *record ) {
+  uint32_t n = bank_count(h, level);
+  if(n == 0) { return false; }
+
+  // k-th record over the grades of the level
+  uint32_t k = rng_range(r, n);
+  for( int g=0; g<BANK_GRADES; ++g ) {
+    const bank_index *ix = &h->index[level][g];
+    if(k < ix->count) {
+      *record = ix->first + k;
+      return true;
+    }
+    k -= ix->count;
+  }
+  return false;
+}
+
+int bank_grade( const uint8_t *cells ) {
+  solver_state s;
+  if( !solver_load(&s, cells) || !solver_solve(&s, SOLVER_MRV) ) { return BANK_GRADES - 1; }
+
+  uint32_t guesses = s.stats.nodes;
+  if(guesses == 0) { return 0; }
+  if(guesses <= 4) { return 1; }
+  if(guesses <= 16) { return 2; }
+  return 3;
+}
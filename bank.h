@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// puzzle bank file
+//
+// pre-generated unique puzzles, read from the SD card by the game and
+// written by build-host/sudoku-bank. all numbers are little-endian.
+//
+//   header  BANK_HEADER bytes
+//     0   "SDKB"
+//     4   BANK_VERSION
+//     5   BANK_LEVELS, BANK_GRADES, BANK_RECORD
+//     8   index, for each level then each grade:
+//           first record (4 bytes), number of records (4 bytes)
+//   records BANK_RECORD bytes each, record k at bank_offset(k)
+//     a board (see board.h) holding the soln, with the givens fixed:
+//     41 bytes of packed values, then 11 bytes of fixed bits
+//
+// levels are easy, medium and hard as in generator.h. grades split each
+// level by how hard the puzzle is to solve, see bank_grade(). taking a
+// puzzle is one read of the header at start, then one seek and one read
+// of BANK_RECORD bytes per puzzle.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BANK_H
+#define BANK_H
+
+#include<stdint.h>
+
+#include "board.h"
+#include "rng.h"
+
+#define BANK_FILE    "SUDOKU.BIN" // 8.3 name on the SD card
+#define BANK_VERSION 1
+#define BANK_LEVELS  3
+#define BANK_GRADES  4
+#define BANK_RECORD  52 // sizeof(board)
+#define BANK_HEADER  (8 + BANK_LEVELS * BANK_GRADES * 8)
+
+struct bank_index {
+  uint32_t first; // record number
+  uint32_t count;
+};
+
+struct bank_header {
+  bank_index index[BANK_LEVELS][BANK_GRADES];
+};
+
+// reads a header from BANK_HEADER bytes
+// false --> not a bank, or another version or layout
+bool bank_read_header( const uint8_t *bytes, bank_header *h );
+void bank_write_header( const bank_header *h, uint8_t *bytes );
+
+// byte offset of record k in the file
+inline uint32_t bank_offset( uint32_t k ) { return BANK_HEADER + k * (uint32_t)BANK_RECORD; }
+
+// record from/to BANK_RECORD bytes
+void bank_read_record( const uint8_t *bytes, board *soln );
+void bank_write_record( const board *soln, uint8_t *bytes );
+
+// records of a level, all grades
+uint32_t bank_count( const bank_header *h, int level );
+
+// picks a random record of a level, any grade
+// false --> the level has none
+bool bank_pick( const bank_header *h, int level, rng_state *r, uint32_t *record );
+
+// grade of a unique puzzle, 0 to BANK_GRADES-1, from the values the MRV
+// search of solver.h had to guess: 0 --> singles only
+int bank_grade( const uint8_t *cells );
+
+#endif
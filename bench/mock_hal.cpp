@@ -0,0 +1,58 @@
+#include<chrono>
+
+#include "hal.h"
+#include "mock_hal.h"
+
+mock_spi mock_stat;
+
+static std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+static void count( uint32_t windows, uint32_t pixels ) {
+  mock_stat.windows += windows;
+  mock_stat.pixels += pixels;
+}
+
+void hal_init() {}
+
+void hal_fill_screen( uint16_t color ) { hal_fill_rect(0, 0, TFT_WIDTH, TFT_HEIGHT, color); }
+
+void hal_draw_rect( int x, int y, int w, int h, uint16_t color ) { count(4, 2*w + 2*h); }
+
+void hal_fill_rect( int x, int y, int w, int h, uint16_t color ) { count(1, w*h); }
+
+void hal_draw_char( int x, int y, char ch, uint16_t fg, uint16_t bg, uint8_t size ) {
+  count(6*8, 6*8 * size*size);
+}
+
+void hal_text( int x, int y, uint8_t size, uint16_t fg, uint16_t bg, const char *str ) {
+  for( ; *str; ++str, x += 6*size ) { hal_draw_char(x, y, *str, fg, bg, size); }
+}
+
+void hal_window( int x, int y, int w, int h ) { count(1, 0); }
+
+void hal_push_pixels( const uint16_t *pixels, int n ) { count(0, n); }
+
+int hal_joy_read( int axis ) { return 512; }
+bool hal_joy_pressed() { return false; }
+
+int hal_noise() { return 0; }
+
+unsigned long hal_millis() { return hal_micros() / 1000; }
+
+unsigned long hal_micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start).count();
+}
+
+void hal_delay( unsigned long ms ) {}
+void hal_timer( void (*fn)(), uint8_t period ) {}
+
+void hal_serial_print( const char *str ) {}
+void hal_serial_char( char ch ) {}
+void hal_serial_number( uint32_t n ) {}
+
+bool hal_sd_open( const char *name ) { return false; }
+bool hal_sd_read( uint32_t pos, uint8_t *buf, uint16_t n ) { return false; }
+
+bool hal_save_read( uint16_t pos, uint8_t *buf, uint16_t n ) { return false; }
+void hal_save_write( uint16_t pos, const uint8_t *buf, uint16_t n ) {}
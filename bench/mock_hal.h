@@ -0,0 +1,28 @@
+///////////////////////////////////////////////////////////////////////////////
+// display that only counts, for benchmarks
+//
+// bench/mock_hal.cpp implements hal.h without a screen. every call that
+// would set an address window on the ST7735 counts one window (one SPI
+// transaction), and every pixel it would send counts one pixel, the way
+// Adafruit_GFX does it:
+//   hal_fill_rect    1 window, w*h pixels
+//   hal_draw_rect    4 windows (one per side), 2w + 2h pixels
+//   hal_draw_char    a window per font pixel, 6*8 of size*size pixels
+//   hal_window       1 window, hal_push_pixels() then adds n pixels
+// the clock is the host's, the joystick rests, the SD card and the save
+// area are missing.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MOCK_HAL_H
+#define MOCK_HAL_H
+
+#include<stdint.h>
+
+struct mock_spi {
+  uint32_t windows;
+  uint32_t pixels;
+};
+
+extern mock_spi mock_stat;
+
+#endif
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// host benchmark: multi-puzzle SIMD solver vs. the scalar MRV solver
+//
+// build: make host  (build-host/simd_bench)
+// run:   build-host/simd_bench [-r repeat] bench/corpus/*.txt
+//        build-host/sudoku-gen --count 100000 > big.txt; build-host/simd_bench big.txt
+//
+// solves all puzzles of the given files (repeated -r times) with every
+// instruction set this CPU has and prints puzzles/s, the speedup over the
+// scalar solver and the share of puzzles finished by propagation alone.
+// exits with 1 if any soln is wrong or the solvers disagree on which
+// puzzles have a soln.
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<chrono>
+#include<vector>
+
+#include "solver.h"
+#include "solver_simd.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+// reads 81 squares from a corpus line. false --> not a puzzle
+static bool parse_puzzle( const char *line, uint8_t *cells ) {
+  int n = 0;
+  for( const char *p = line; *p && *p != '\n' && *p != '\r'; ++p ) {
+    if(n == 81) { return false; }
+    if(*p >= '1' && *p <= '9') { cells[n++] = *p - '0'; }
+    else if(*p == '.' || *p == '0') { cells[n++] = 0; }
+    else { return false; }
+  }
+  return n == 81;
+}
+
+// soln keeps the givens and fills every row, col and box with 1 to 9
+static bool valid_soln( const uint8_t *cells, const uint8_t *soln ) {
+  uint16_t row[9] = {}, col[9] = {}, box[9] = {};
+  for( int i=0; i<81; ++i ) {
+    if(cells[i] && cells[i] != soln[i]) { return false; }
+    if(soln[i] < 1 || soln[i] > 9) { return false; }
+    uint16_t bit = solver_bit(soln[i]);
+    row[i / 9] |= bit;
+    col[i % 9] |= bit;
+    box[solver_box(i / 9, i % 9)] |= bit;
+  }
+  for( int k=0; k<9; ++k ) {
+    if(row[k] != SOLVER_ALL || col[k] != SOLVER_ALL || box[k] != SOLVER_ALL) { return false; }
+  }
+  return true;
+}
+
+int main( int argc, char **argv ) {
+  int repeat = 1;
+  std::vector<uint8_t> cells;
+
+  for( int a=1; a<argc; ++a ) {
+    if( strcmp(argv[a], "-r") == 0 && a + 1 < argc ) { repeat = atoi(argv[++a]); continue; }
+
+    FILE *f = fopen(argv[a], "r");
+    if(!f) {
+      fprintf(stderr, "cannot open %s\n", argv[a]);
+      return 1;
+    }
+    char line[256];
+    uint8_t puzzle[81];
+    while( fgets(line, sizeof(line), f) ) {
+      if(line[0] == '#' || !parse_puzzle(line, puzzle)) { continue; }
+      cells.insert(cells.end(), puzzle, puzzle + 81);
+    }
+    fclose(f);
+  }
+
+  std::vector<uint8_t> one(cells);
+  for( int r=1; r<repeat; ++r ) { cells.insert(cells.end(), one.begin(), one.end()); }
+
+  int n = (int)(cells.size() / 81);
+  if(n == 0) {
+    fprintf(stderr, "usage: simd_bench [-r repeat] files...\n");
+    return 2;
+  }
+
+  std::vector<uint8_t> solns(cells.size());
+  std::vector<char> ref_ok(n);
+  bool *ok = new bool[n];
+
+  printf("%-8s %8s %12s %8s %12s\n", "isa", "n", "puzzles/s", "speedup", "propagated");
+
+  int failures = 0;
+  double scalar_rate = 0;
+  int best = simd_best();
+  for( int isa=SIMD_SCALAR; isa<=best; ++isa ) {
+    simd_stats st = {};
+    bench_clock::time_point start = bench_clock::now();
+    simd_solve(isa, &cells[0], n, &solns[0], ok, &st);
+    double secs = std::chrono::duration<double>( bench_clock::now() - start ).count();
+
+    for( int p=0; p<n; ++p ) {
+      if(isa == SIMD_SCALAR) { ref_ok[p] = ok[p]; }
+      bool same = (ok[p] == (bool)ref_ok[p]);
+      if(same && ok[p]) { same = valid_soln(&cells[p*81], &solns[p*81]); }
+      if(!same) { failures++; }
+    }
+
+    double rate = n / secs;
+    if(isa == SIMD_SCALAR) { scalar_rate = rate; }
+    printf("%-8s %8d %12.0f %7.2fx %11.1f%%\n", simd_name(isa), n, rate,
+           rate / scalar_rate, 100.0 * st.propagated / st.puzzles);
+  }
+
+  delete[] ok;
+  if(failures) { printf("%d MISMATCH\n", failures); }
+  return failures ? 1 : 0;
+}
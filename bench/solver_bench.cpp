@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////
+// host benchmark: old test_row/test_col/test_box solver vs. the bitmask
+// solver in row-major and MRV order vs. Dancing Links
+//
+// build: make host  (build-host/solver_bench)
+// run:   build-host/solver_bench [--no-legacy] [-v] bench/corpus/*.txt
+//
+// prints average time and search nodes per puzzle for each corpus file,
+// -v also prints every puzzle. --no-legacy skips the old solver, which
+// takes seconds on corpus/extreme.txt
+// every puzzle is also counted (stopping at 2) by count_solutions() and by
+// DLX. the backends must agree on 0 / 1 / 2+ solns and on the soln of
+// unique puzzles.
+// exits with 1 if the solvers disagree on any puzzle.
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<string.h>
+#include<stdint.h>
+#include<chrono>
+
+#include "solver.h"
+#include "dlx.h"
+
+// copy of the solver sudoku.cpp used before solver.h existed
+namespace legacy {
+
+struct sudoku_grid {
+  uint8_t value;
+  bool fixed;
+};
+sudoku_grid grid[9][9];
+
+bool test_row( int row, int col ) {
+  for( int j=0; j<9; ++j ) {
+    if(j != col) {
+      if( grid[row][j].value == grid[row][col].value ) { return false; }
+    }
+  }
+  return true;
+}
+
+bool test_col( int row, int col ) {
+  for( int i=0; i<9; ++i ) {
+    if(i != row) {
+      if( grid[i][col].value == grid[row][col].value ) { return false; }
+    }
+  }
+  return true;
+}
+
+bool test_box( int row, int col ) {
+  int irow = (row / 3) * 3;
+  int icol = (col / 3) * 3;
+
+  for( int i=irow; i<irow + 3; ++i ) {
+    for( int j=icol; j<icol + 3; ++j ) {
+      if( (i != row) && (j != col) ) {
+        if( grid[i][j].value == grid[row][col].value ) { return false; }
+      }
+    }
+  }
+  return true;
+}
+
+bool solve_grid( int row, int col ) {
+  while(grid[row][col].fixed == true) {
+    col++;
+    if(col > 8) {
+      col = 0;
+      row++;
+    }
+    if(row > 8) { return true; }
+  }
+
+  for( int n=1; n<10; ++n ) {
+    grid[row][col].value = n;
+    if( test_col( row, col ) && test_row( row, col ) && test_box( row, col ) ) {
+      int next_row = row;
+      int next_col = col + 1;
+      if(next_col > 8) {
+        next_col = 0;
+        next_row++;
+      }
+      if(next_row > 8) { return true; }
+      if( solve_grid( next_row, next_col ) ) { return true; }
+    }
+  }
+  grid[row][col].value = 0;
+  return false;
+}
+
+} // namespace legacy
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_us( bench_clock::time_point start ) {
+  return std::chrono::duration<double, std::micro>( bench_clock::now() - start ).count();
+}
+
+// reads 81 squares from a corpus line. false --> not a puzzle
+static bool parse_puzzle( const char *line, uint8_t *cells ) {
+  int n = 0;
+  for( const char *p = line; *p && *p != '\n' && *p != '\r'; ++p ) {
+    if(n == 81) { return false; }
+    if(*p >= '1' && *p <= '9') { cells[n++] = *p - '0'; }
+    else if(*p == '.' || *p == '0') { cells[n++] = 0; }
+    else { return false; }
+  }
+  return n == 81;
+}
+
+// totals for one corpus file
+struct bench_total {
+  int count;
+  double legacy_us;
+  double row_us;
+  double mrv_us;
+  double row_nodes;
+  double mrv_nodes;
+  double count_us;
+  double dlx_us;
+};
+
+static dlx_state dlx;
+
+static bool same_soln( const solver_state *a, const solver_state *b ) {
+  for( int i=0; i<81; ++i ) {
+    if(a->cell[i] != b->cell[i]) { return false; }
+  }
+  return true;
+}
+
+// runs every solver on each puzzle of a corpus file
+// returns the number of puzzles the solvers disagree on
+static int bench_file( const char *path, bool run_legacy, bool verbose, bench_total *t ) {
+  FILE *f = fopen(path, "r");
+  if(!f) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+
+  char line[256];
+  int failures = 0;
+  while( fgets(line, sizeof(line), f) ) {
+    uint8_t cells[81];
+    if(line[0] == '#' || !parse_puzzle(line, cells)) { continue; }
+
+    double legacy_us = 0;
+    bool legacy_ok = false;
+    if(run_legacy) {
+      for( int i=0; i<81; ++i ) {
+        legacy::grid[i / 9][i % 9].value = cells[i];
+        legacy::grid[i / 9][i % 9].fixed = (cells[i] != 0);
+      }
+      bench_clock::time_point start = bench_clock::now();
+      legacy_ok = legacy::solve_grid(0, 0);
+      legacy_us = elapsed_us(start);
+    }
+
+    solver_state row;
+    bench_clock::time_point start = bench_clock::now();
+    bool row_ok = solver_load(&row, cells) && solver_solve(&row, SOLVER_ROW_MAJOR);
+    double row_us = elapsed_us(start);
+
+    solver_state mrv;
+    start = bench_clock::now();
+    bool mrv_ok = solver_load(&mrv, cells) && solver_solve(&mrv, SOLVER_MRV);
+    double mrv_us = elapsed_us(start);
+
+    uint8_t dlx_soln[81];
+    start = bench_clock::now();
+    int dlx_solns = dlx_count(&dlx, cells, 2, dlx_soln);
+    double dlx_us = elapsed_us(start);
+
+    start = bench_clock::now();
+    int mrv_solns = count_solutions(cells, 2);
+    double count_us = elapsed_us(start);
+
+    // row-major must match the old solver exactly. MRV may pick another
+    // soln only if the puzzle has more than one
+    bool same = (row_ok == mrv_ok) && (dlx_solns == mrv_solns);
+    if(mrv_solns == 1) { same = same && memcmp(dlx_soln, mrv.cell, 81) == 0; }
+    if(run_legacy) {
+      same = same && (legacy_ok == row_ok);
+      for( int i=0; same && row_ok && i<81; ++i ) {
+        if( legacy::grid[i / 9][i % 9].value != row.cell[i] ) { same = false; }
+      }
+    }
+    if(!same) { failures++; }
+
+    if(verbose) {
+      printf("  %-4d %12.1f %12.1f %10u %12.1f %10u %12.1f %12.1f%s\n", t->count,
+             legacy_us, row_us, row.stats.nodes, mrv_us, mrv.stats.nodes, count_us, dlx_us,
+             same ? (same_soln(&row, &mrv) ? "" : "  (not unique)") : "  MISMATCH");
+    }
+
+    t->count++;
+    t->legacy_us += legacy_us;
+    t->row_us += row_us;
+    t->mrv_us += mrv_us;
+    t->row_nodes += row.stats.nodes;
+    t->mrv_nodes += mrv.stats.nodes;
+    t->count_us += count_us;
+    t->dlx_us += dlx_us;
+  }
+  fclose(f);
+  return failures;
+}
+
+int main( int argc, char **argv ) {
+  bool run_legacy = true;
+  bool verbose = false;
+  int failures = 0;
+
+  printf("%-22s %5s %12s %12s %10s %12s %10s %12s %12s\n", "corpus", "n", "legacy_us",
+         "row_us", "row_nodes", "mrv_us", "mrv_nodes", "count_us", "dlx_us");
+
+  for( int a=1; a<argc; ++a ) {
+    if( strcmp(argv[a], "--no-legacy") == 0 ) { run_legacy = false; continue; }
+    if( strcmp(argv[a], "-v") == 0 ) { verbose = true; continue; }
+
+    bench_total t = {};
+    failures += bench_file(argv[a], run_legacy, verbose, &t);
+    if(t.count == 0) { continue; }
+
+    // averages per puzzle
+    printf("%-22s %5d %12.1f %12.1f %10.0f %12.1f %10.0f %12.1f %12.1f\n", argv[a],
+           t.count, t.legacy_us / t.count, t.row_us / t.count, t.row_nodes / t.count,
+           t.mrv_us / t.count, t.mrv_nodes / t.count, t.count_us / t.count,
+           t.dlx_us / t.count);
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////
+// host benchmark suite: solver, uniqueness check, hints, generator and
+// renderer
+//
+// build: make host  (build-host/bench_suite)
+// run:   build-host/bench_suite [-r repeat] [--gen N] [--baseline old.txt]
+//                               [--tolerance pct] [corpus files]
+//        make host-bench [BASELINE=old.txt]
+//
+// with no files it reads bench/corpus/{easy,medium,hard,extreme,
+// pathological}.txt. for each file it times solver_solve() in row-major
+// and MRV order and the uniqueness check (count_solutions(cells, 2)),
+// taking the fastest of -r passes over the file, and plays each puzzle
+// through with the hints of hint.h, timing the slowest hint_step(). it generates N puzzles
+// per difficulty from a fixed seed, and draws the board against the
+// counting display of bench/mock_hal.h: a full draw, the cursor walking
+// every square, and 20 squares being filled in (10*repeat passes).
+//
+// stdout gets one metric per line, always in the same order:
+//   name value unit
+// e.g. "solve.mrv.hard 10.52 us". save it, and --baseline compares a new
+// run with it on stderr. a timing (unit us) more than --tolerance percent
+// slower (default 10), or any count (nodes, checks, windows, pixels)
+// higher than the baseline is a regression, and the exit status is 1.
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<math.h>
+#include<chrono>
+#include<map>
+#include<string>
+#include<vector>
+
+#include "solver.h"
+#include "generator.h"
+#include "hint.h"
+#include "render.h"
+#include "mock_hal.h"
+
+typedef std::chrono::steady_clock bench_clock;
+
+static double elapsed_us( bench_clock::time_point start ) {
+  return std::chrono::duration<double, std::micro>( bench_clock::now() - start ).count();
+}
+
+struct metric {
+  std::string name;
+  double value;
+  std::string unit;
+};
+
+static std::vector<metric> results;
+
+// values are kept as printed, so a run compares the same with its output
+static void report( const std::string &name, double value, const char *unit ) {
+  value = (double)llround(value * 100) / 100;
+  metric m = { name, value, unit };
+  results.push_back(m);
+  printf("%s %.2f %s\n", name.c_str(), value, unit);
+}
+
+// reads 81 squares from a corpus line. false --> not a puzzle
+static bool parse_puzzle( const char *line, uint8_t *cells ) {
+  int n = 0;
+  for( const char *p = line; *p && *p != '\n' && *p != '\r'; ++p ) {
+    if(n == 81) { return false; }
+    if(*p >= '1' && *p <= '9') { cells[n++] = *p - '0'; }
+    else if(*p == '.' || *p == '0') { cells[n++] = 0; }
+    else { return false; }
+  }
+  return n == 81;
+}
+
+// "bench/corpus/hard.txt" --> "hard"
+static std::string corpus_name( const char *path ) {
+  const char *slash = strrchr(path, '/');
+  std::string name = slash ? slash + 1 : path;
+  size_t dot = name.rfind('.');
+  return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static bool read_corpus( const char *path, std::vector<uint8_t> *cells ) {
+  FILE *f = fopen(path, "r");
+  if(!f) { return false; }
+  char line[256];
+  uint8_t c[81];
+  while( fgets(line, sizeof(line), f) ) {
+    if(line[0] != '#' && parse_puzzle(line, c)) { cells->insert(cells->end(), c, c + 81); }
+  }
+  fclose(f);
+  return true;
+}
+
+// fastest of repeat passes over the puzzles, in us per puzzle
+// *nodes gets the search nodes per puzzle, the same every pass
+enum bench_op { OP_ROW, OP_MRV, OP_UNIQUE };
+
+static double time_op( const std::vector<uint8_t> &cells, bench_op op, int repeat, double *nodes ) {
+  size_t n = cells.size() / 81;
+  double best = 0;
+  for( int r=0; r<repeat; ++r ) {
+    uint64_t total_nodes = 0;
+    bench_clock::time_point start = bench_clock::now();
+    for( size_t k=0; k<n; ++k ) {
+      solver_state s;
+      if( !solver_load(&s, &cells[k * 81]) ) { continue; }
+      if(op == OP_ROW) { solver_solve(&s, SOLVER_ROW_MAJOR); }
+      else if(op == OP_MRV) { solver_solve(&s, SOLVER_MRV); }
+      else { solver_count_solutions(&s, 2); }
+      total_nodes += s.stats.nodes;
+    }
+    double us = elapsed_us(start) / n;
+    if(r == 0 || us < best) { best = us; }
+    *nodes = (double)total_nodes / n;
+  }
+  return best;
+}
+
+// every puzzle played by taking hints until it is solved
+// returns the slowest hint_step() in us, the lowest of repeat passes
+// *steps gets the hint_step() calls per puzzle
+static double time_hints( const std::vector<uint8_t> &cells, int repeat, double *steps ) {
+  size_t n = cells.size() / 81;
+  double best = 0;
+  for( int r=0; r<repeat; ++r ) {
+    uint64_t total_steps = 0;
+    double slowest = 0;
+    for( size_t k=0; k<n; ++k ) {
+      solver_state s;
+      if( !solver_load(&s, &cells[k * 81]) || !solver_solve(&s, SOLVER_MRV) ) { continue; }
+      board soln, grid;
+      board_load(&soln, s.cell);
+      board_load(&grid, &cells[k * 81]);
+
+      hint_state h;
+      hint_load(&h, &grid);
+      bool found = true;
+      while(found) {
+        hint_start(&h);
+        found = false;
+        while(h.busy) {
+          bench_clock::time_point start = bench_clock::now();
+          found = hint_step(&h, &soln);
+          double us = elapsed_us(start);
+          if(us > slowest) { slowest = us; }
+          total_steps++;
+        }
+        if(found) { hint_set(&h, h.why.square, h.why.value); }
+      }
+    }
+    if(r == 0 || slowest < best) { best = slowest; }
+    *steps = (double)total_steps / n;
+  }
+  return best;
+}
+
+static void bench_solver( const char *path, int repeat ) {
+  std::vector<uint8_t> cells;
+  if( !read_corpus(path, &cells) || cells.empty() ) {
+    fprintf(stderr, "cannot read %s\n", path);
+    exit(2);
+  }
+
+  std::string name = corpus_name(path);
+  double nodes;
+  double us = time_op(cells, OP_ROW, repeat, &nodes);
+  report("solve.row." + name, us, "us");
+  report("solve.row." + name + ".nodes", nodes, "nodes");
+  us = time_op(cells, OP_MRV, repeat, &nodes);
+  report("solve.mrv." + name, us, "us");
+  report("solve.mrv." + name + ".nodes", nodes, "nodes");
+  us = time_op(cells, OP_UNIQUE, repeat, &nodes);
+  report("unique." + name, us, "us");
+  report("unique." + name + ".nodes", nodes, "nodes");
+  us = time_hints(cells, repeat, &nodes);
+  report("hint." + name, us, "us");
+  report("hint." + name + ".steps", nodes, "steps");
+}
+
+// puzzles of the game's difficulties, and minimal ones, from one seed
+static void bench_generator( int count ) {
+  static const char *const names[] = { "easy", "medium", "hard", "minimal" };
+  static const int strikes[] = { GEN_EASY, GEN_MEDIUM, GEN_HARD, GEN_MINIMAL };
+
+  for( int l=0; l<4; ++l ) {
+    gen_state g;
+    gen_init(&g, 12345);
+    uint32_t givens = 0;
+    bench_clock::time_point start = bench_clock::now();
+    for( int k=0; k<count; ++k ) {
+      gen_puzzle(&g, strikes[l]);
+      givens += 81 - g.struck;
+    }
+    double us = elapsed_us(start) / count;
+
+    std::string name = std::string("gen.") + names[l];
+    report(name, us, "us");
+    report(name + ".checks", (double)g.stats.checks / count, "checks");
+    report(name + ".givens", (double)givens / count, "givens");
+  }
+}
+
+// the ways the game draws the board, each one a run of frames
+#define DRAW_FULL   0 // everything, as after the menu
+#define DRAW_CURSOR 1 // cursor over every square, then the buttons
+#define DRAW_EDIT   2 // 20 squares filled in, one per frame
+#define DRAWS       3
+
+// one pass over the draws of a puzzle and its soln
+// us, windows and pixels get the totals of each draw, frames its frames
+static void draw_pass( const board *puzzle, const board *soln, double *us,
+                       mock_spi *spi, int *frames ) {
+  board b = *puzzle;
+  for( int d=0; d<DRAWS; ++d ) {
+    mock_stat = mock_spi();
+    frames[d] = 0;
+    bench_clock::time_point start = bench_clock::now();
+
+    if(d == DRAW_FULL) {
+      render_invalidate_all();
+      render_board(&b, NULL, NULL, NULL, 0, 0, 0);
+      frames[d]++;
+    }
+    else if(d == DRAW_CURSOR) {
+      for( int i=1; i<81; ++i, ++frames[d] ) { render_board(&b, NULL, NULL, NULL, 0, i % 9, i / 9); }
+      for( int x=0; x<2; ++x, ++frames[d] ) { render_board(&b, NULL, NULL, NULL, 0, x, 9); }
+    }
+    else {
+      for( uint8_t i=0; i<81 && frames[d] < 20; ++i ) {
+        if( board_get(&b, i) ) { continue; }
+        board_set(&b, i, board_get(soln, i));
+        render_board(&b, NULL, NULL, NULL, 0, i % 9, i / 9);
+        frames[d]++;
+      }
+    }
+
+    us[d] = elapsed_us(start);
+    spi[d] = mock_stat;
+  }
+}
+
+// the first puzzle of a fixed seed against the counting display, the
+// fastest of repeat passes. counts are the same every pass
+static void bench_render( int repeat ) {
+  static const char *const names[DRAWS] = { "full", "cursor", "edit" };
+
+  gen_state g;
+  gen_init(&g, 12345);
+  gen_puzzle(&g, GEN_HARD);
+  board b;
+  uint8_t cells[81];
+  board_givens(&g.puzzle, cells);
+  board_load(&b, cells);
+
+  double best[DRAWS], us[DRAWS];
+  mock_spi spi[DRAWS];
+  int frames[DRAWS];
+  for( int r=0; r<repeat; ++r ) {
+    draw_pass(&b, &g.soln, us, spi, frames);
+    for( int d=0; d<DRAWS; ++d ) {
+      if(r == 0 || us[d] < best[d]) { best[d] = us[d]; }
+    }
+  }
+
+  for( int d=0; d<DRAWS; ++d ) {
+    std::string n = std::string("draw.") + names[d];
+    report(n + ".windows", (double)spi[d].windows / frames[d], "windows");
+    report(n + ".pixels", (double)spi[d].pixels / frames[d], "pixels");
+    report(n, best[d] / frames[d], "us");
+  }
+}
+
+// compares results with a saved run, returns the number of regressions
+static int compare( const char *path, double tolerance ) {
+  FILE *f = fopen(path, "r");
+  if(!f) {
+    fprintf(stderr, "cannot read %s\n", path);
+    exit(2);
+  }
+  std::map<std::string, double> base;
+  char name[128], unit[32];
+  double value;
+  while( fscanf(f, "%127s %lf %31s", name, &value, unit) == 3 ) { base[name] = value; }
+  fclose(f);
+
+  int regressions = 0;
+  fprintf(stderr, "%-32s %12s %12s %8s\n", "metric", "baseline", "now", "change");
+  for( size_t k=0; k<results.size(); ++k ) {
+    const metric &m = results[k];
+    if( base.find(m.name) == base.end() ) {
+      fprintf(stderr, "%-32s %12s %12.2f %8s\n", m.name.c_str(), "-", m.value, "new");
+      continue;
+    }
+    double b = base[m.name];
+    double change = b ? (m.value - b) / b * 100 : 0;
+    // counts do not depend on the machine, any increase is real
+    bool timing = (m.unit == "us");
+    bool worse = timing ? change > tolerance : m.value > b;
+    if(worse) { regressions++; }
+    fprintf(stderr, "%-32s %12.2f %12.2f %+7.1f%%%s\n", m.name.c_str(), b, m.value, change,
+            worse ? "  REGRESSION" : "");
+  }
+  fprintf(stderr, "%d regressions\n", regressions);
+  return regressions;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: bench_suite [-r repeat] [--gen N] [--baseline old.txt]"
+                  " [--tolerance pct] [corpus files]\n");
+  exit(2);
+}
+
+int main( int argc, char **argv ) {
+  int repeat = 3;
+  int gen_count = 100;
+  const char *baseline = NULL;
+  double tolerance = 10;
+  std::vector<const char *> files;
+
+  for( int a=1; a<argc; ++a ) {
+    const char *arg = argv[a];
+    if(arg[0] != '-') { files.push_back(arg); continue; }
+    if(a + 1 == argc) { usage(); }
+    const char *val = argv[++a];
+    if( strcmp(arg, "-r") == 0 ) { repeat = atoi(val); }
+    else if( strcmp(arg, "--gen") == 0 ) { gen_count = atoi(val); }
+    else if( strcmp(arg, "--baseline") == 0 ) { baseline = val; }
+    else if( strcmp(arg, "--tolerance") == 0 ) { tolerance = atof(val); }
+    else { usage(); }
+  }
+  if(repeat < 1 || gen_count < 1) { usage(); }
+  if( files.empty() ) {
+    static const char *const corpus[] = {
+      "bench/corpus/easy.txt", "bench/corpus/medium.txt", "bench/corpus/hard.txt",
+      "bench/corpus/extreme.txt", "bench/corpus/pathological.txt"
+    };
+    files.assign(corpus, corpus + 5);
+  }
+
+  for( size_t k=0; k<files.size(); ++k ) { bench_solver(files[k], repeat); }
+  bench_generator(gen_count);
+  bench_render(repeat * 10);
+  fflush(stdout);
+
+  if(baseline && compare(baseline, tolerance)) { return 1; }
+  return 0;
+}
@@ -0,0 +1,25 @@
+#include<string.h>
+
+#include "board.h"
+
+void board_clear( board *b ) {
+  memset(b, 0, sizeof(board));
+}
+
+void board_load( board *b, const uint8_t *cells ) {
+  board_clear(b);
+  for( uint8_t i=0; i<81; ++i ) {
+    board_set(b, i, cells[i]);
+    board_set_fixed(b, i, cells[i] != 0);
+  }
+}
+
+void board_unpack( const board *b, uint8_t *cells ) {
+  for( uint8_t i=0; i<81; ++i ) { cells[i] = board_get(b, i); }
+}
+
+void board_givens( const board *b, uint8_t *cells ) {
+  for( uint8_t i=0; i<81; ++i ) {
+    cells[i] = board_is_fixed(b, i) ? board_get(b, i) : 0;
+  }
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// packed board
+//
+// 81 squares in 52 bytes: a 4-bit value per square, two to a byte, and a
+// separate bit per square for the fixed (given) squares. a sudoku_grid
+// struct per square used 2 bytes, 162 for a board.
+//
+// squares are indexed row-major: index = row*9 + col. the row, col and
+// box of every square and the squares of every unit are constexpr tables,
+// kept in flash on the Mega. read them with board_row() and friends.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include<stdint.h>
+
+#ifdef __AVR__
+#include<avr/pgmspace.h>
+#else
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#endif
+
+struct board {
+  uint8_t value[41]; // square i: low nibble of value[i/2] if i is even, else high
+  uint8_t fixed[11]; // square i: bit i%8 of fixed[i/8]
+};
+
+// row, col and box (0 to 8, left to right then top to bottom) of each square
+constexpr uint8_t board_row_of[81] PROGMEM = {
+  0,0,0,0,0,0,0,0,0,
+  1,1,1,1,1,1,1,1,1,
+  2,2,2,2,2,2,2,2,2,
+  3,3,3,3,3,3,3,3,3,
+  4,4,4,4,4,4,4,4,4,
+  5,5,5,5,5,5,5,5,5,
+  6,6,6,6,6,6,6,6,6,
+  7,7,7,7,7,7,7,7,7,
+  8,8,8,8,8,8,8,8,8
+};
+constexpr uint8_t board_col_of[81] PROGMEM = {
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8,
+  0,1,2,3,4,5,6,7,8
+};
+constexpr uint8_t board_box_of[81] PROGMEM = {
+  0,0,0,1,1,1,2,2,2,
+  0,0,0,1,1,1,2,2,2,
+  0,0,0,1,1,1,2,2,2,
+  3,3,3,4,4,4,5,5,5,
+  3,3,3,4,4,4,5,5,5,
+  3,3,3,4,4,4,5,5,5,
+  6,6,6,7,7,7,8,8,8,
+  6,6,6,7,7,7,8,8,8,
+  6,6,6,7,7,7,8,8,8
+};
+
+// square indices of the 27 units: rows, then cols, then boxes
+constexpr uint8_t board_units[27][9] PROGMEM = {
+  {  0, 1, 2, 3, 4, 5, 6, 7, 8 }, {  9,10,11,12,13,14,15,16,17 },
+  { 18,19,20,21,22,23,24,25,26 }, { 27,28,29,30,31,32,33,34,35 },
+  { 36,37,38,39,40,41,42,43,44 }, { 45,46,47,48,49,50,51,52,53 },
+  { 54,55,56,57,58,59,60,61,62 }, { 63,64,65,66,67,68,69,70,71 },
+  { 72,73,74,75,76,77,78,79,80 }, {  0, 9,18,27,36,45,54,63,72 },
+  {  1,10,19,28,37,46,55,64,73 }, {  2,11,20,29,38,47,56,65,74 },
+  {  3,12,21,30,39,48,57,66,75 }, {  4,13,22,31,40,49,58,67,76 },
+  {  5,14,23,32,41,50,59,68,77 }, {  6,15,24,33,42,51,60,69,78 },
+  {  7,16,25,34,43,52,61,70,79 }, {  8,17,26,35,44,53,62,71,80 },
+  {  0, 1, 2, 9,10,11,18,19,20 }, {  3, 4, 5,12,13,14,21,22,23 },
+  {  6, 7, 8,15,16,17,24,25,26 }, { 27,28,29,36,37,38,45,46,47 },
+  { 30,31,32,39,40,41,48,49,50 }, { 33,34,35,42,43,44,51,52,53 },
+  { 54,55,56,63,64,65,72,73,74 }, { 57,58,59,66,67,68,75,76,77 },
+  { 60,61,62,69,70,71,78,79,80 }
+};
+
+inline uint8_t board_row( uint8_t i ) { return pgm_read_byte( &board_row_of[i] ); }
+inline uint8_t board_col( uint8_t i ) { return pgm_read_byte( &board_col_of[i] ); }
+inline uint8_t board_box( uint8_t i ) { return pgm_read_byte( &board_box_of[i] ); }
+inline uint8_t board_unit( uint8_t u, uint8_t k ) { return pgm_read_byte( &board_units[u][k] ); }
+
+// value of a square, 0 == empty
+inline uint8_t board_get( const board *b, uint8_t i ) {
+  uint8_t v = b->value[i >> 1];
+  return (i & 1) ? (v >> 4) : (v & 0x0F);
+}
+
+inline void board_set( board *b, uint8_t i, uint8_t n ) {
+  uint8_t *v = &b->value[i >> 1];
+  if(i & 1) { *v = (*v & 0x0F) | (n << 4); }
+  else      { *v = (*v & 0xF0) | n; }
+}
+
+inline bool board_is_fixed( const board *b, uint8_t i ) {
+  return (b->fixed[i >> 3] >> (i & 7)) & 1;
+}
+
+inline void board_set_fixed( board *b, uint8_t i, bool fixed ) {
+  uint8_t bit = 1 << (i & 7);
+  if(fixed) { b->fixed[i >> 3] |= bit; }
+  else      { b->fixed[i >> 3] &= ~bit; }
+}
+
+// all squares empty and not fixed
+void board_clear( board *b );
+
+// packs 81 values (0 == empty). non empty squares become fixed
+void board_load( board *b, const uint8_t *cells );
+
+// unpacks all 81 values
+void board_unpack( const board *b, uint8_t *cells );
+
+// unpacks the fixed squares only, the rest are 0
+void board_givens( const board *b, uint8_t *cells );
+
+#endif
@@ -0,0 +1,78 @@
+#include<string.h>
+
+#include "check.h"
+
+static uint8_t get_count( const check_state *c, uint8_t u, uint8_t n ) {
+  uint8_t k = u*9 + n - 1;
+  uint8_t v = c->count[k >> 1];
+  return (k & 1) ? (v >> 4) : (v & 0x0F);
+}
+
+static void set_count( check_state *c, uint8_t u, uint8_t n, uint8_t count ) {
+  uint8_t k = u*9 + n - 1;
+  uint8_t *v = &c->count[k >> 1];
+  if(k & 1) { *v = (*v & 0x0F) | (count << 4); }
+  else      { *v = (*v & 0xF0) | count; }
+}
+
+// units of square i: row, col and box
+static void units_of( uint8_t i, uint8_t *units ) {
+  units[0] = board_row(i);
+  units[1] = 9 + board_col(i);
+  units[2] = 18 + board_box(i);
+}
+
+// n added (+1) or taken (-1) off the units of square i
+static void count_value( check_state *c, uint8_t i, uint8_t n, int d ) {
+  uint8_t units[3];
+  units_of(i, units);
+  for( int k=0; k<3; ++k ) {
+    uint8_t was = get_count(c, units[k], n);
+    set_count(c, units[k], n, was + d);
+    if(d > 0 && was == 1) { c->clashes++; }
+    if(d < 0 && was == 2) { c->clashes--; }
+  }
+  c->filled += d;
+}
+
+// the value of square i is also elsewhere on its row, col or box
+static bool clashes( const check_state *c, const board *b, uint8_t i ) {
+  uint8_t n = board_get(b, i);
+  if(n == 0) { return false; }
+  uint8_t units[3];
+  units_of(i, units);
+  for( int k=0; k<3; ++k ) {
+    if(get_count(c, units[k], n) > 1) { return true; }
+  }
+  return false;
+}
+
+static void mark( check_state *c, const board *b, uint8_t i ) {
+  uint8_t bit = 1 << (i & 7);
+  if( clashes(c, b, i) ) { c->conflict[i >> 3] |= bit; }
+  else                   { c->conflict[i >> 3] &= ~bit; }
+}
+
+void check_load( check_state *c, const board *b ) {
+  memset(c, 0, sizeof(check_state));
+  for( uint8_t i=0; i<81; ++i ) {
+    uint8_t n = board_get(b, i);
+    if(n) { count_value(c, i, n, 1); }
+  }
+  for( uint8_t i=0; i<81; ++i ) { mark(c, b, i); }
+}
+
+void check_set( check_state *c, board *b, uint8_t i, uint8_t n ) {
+  uint8_t old = board_get(b, i);
+  if(old == n) { return; }
+  if(old) { count_value(c, i, old, -1); }
+  if(n) { count_value(c, i, n, 1); }
+  board_set(b, i, n);
+
+  // only squares sharing a unit with i can gain or lose a clash
+  uint8_t units[3];
+  units_of(i, units);
+  for( int k=0; k<3; ++k ) {
+    for( uint8_t j=0; j<9; ++j ) { mark(c, b, board_unit(units[k], j)); }
+  }
+}
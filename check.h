@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////////
+// live check of the player's board
+//
+// counts how often each value is on each row, col and box (4 bits a
+// count, 122 bytes) and keeps a bit per square that is set while its
+// value is also elsewhere on its row, col or box. check_set() changes one
+// square and updates the counts of its 3 units and the bits of the
+// squares in them, so there is no scan of the board and no end of game
+// check: the board is solved the moment the last square is filled with
+// no clash left.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include<stdint.h>
+
+#include "board.h"
+
+struct check_state {
+  uint8_t count[122];   // value n on unit u: nibble u*9 + n-1, units as in board.h
+  uint8_t conflict[11]; // square i: bit i%8 of conflict[i/8]
+  uint8_t filled;       // squares with a value
+  uint8_t clashes;      // (unit, value) pairs with the value more than once
+};
+
+// counts the values on b
+void check_load( check_state *c, const board *b );
+
+// puts n (0 == empty) on square i of b and updates c
+void check_set( check_state *c, board *b, uint8_t i, uint8_t n );
+
+inline bool check_conflict( const check_state *c, uint8_t i ) {
+  return (c->conflict[i >> 3] >> (i & 7)) & 1;
+}
+
+// every square filled and no value twice in a unit --> solved
+inline bool check_complete( const check_state *c ) {
+  return c->filled == 81 && c->clashes == 0;
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include "dlx.h"
+#include "solver.h"
+
+#define DLX_COVERED 0x80
+
+// column of a row node
+static uint16_t node_col( const dlx_state *d, uint16_t node ) {
+  int r = (node - DLX_COLS) >> 2;
+  int cell = d->row_cell[r];
+  int n = d->row_value[r] - 1;
+  int row = cell / 9;
+  int col = cell % 9;
+
+  switch( (node - DLX_COLS) & 3 ) {
+    case 0:  return cell;
+    case 1:  return 81 + row*9 + n;
+    case 2:  return 162 + col*9 + n;
+    default: return 243 + solver_box(row, col)*9 + n;
+  }
+}
+
+// next node of the same row, wrapping around its 4 nodes
+static uint16_t node_next( uint16_t node, int step ) {
+  uint16_t first = node - ((node - DLX_COLS) & 3);
+  return first + (((node - DLX_COLS) + step) & 3);
+}
+
+// appends a node to the bottom of its column
+static void link_node( dlx_state *d, uint16_t node, uint16_t col ) {
+  d->up[node] = d->up[col];
+  d->down[node] = col;
+  d->down[ d->up[col] ] = node;
+  d->up[col] = node;
+  d->size[col]++;
+}
+
+// removes every other node of the row from its column
+static void cover_row( dlx_state *d, uint16_t node ) {
+  for( int k=1; k<4; ++k ) {
+    uint16_t j = node_next(node, k);
+    d->down[ d->up[j] ] = d->down[j];
+    d->up[ d->down[j] ] = d->up[j];
+    d->size[ node_col(d, j) ]--;
+  }
+}
+
+// undoes cover_row(), in reverse
+static void uncover_row( dlx_state *d, uint16_t node ) {
+  for( int k=3; k>0; --k ) {
+    uint16_t j = node_next(node, k);
+    d->size[ node_col(d, j) ]++;
+    d->down[ d->up[j] ] = j;
+    d->up[ d->down[j] ] = j;
+  }
+}
+
+// takes a column and every row that meets it out of the matrix
+static void cover( dlx_state *d, uint16_t col ) {
+  d->size[col] |= DLX_COVERED;
+  for( uint16_t i = d->down[col]; i != col; i = d->down[i] ) { cover_row(d, i); }
+}
+
+// undoes cover(), in reverse
+static void uncover( dlx_state *d, uint16_t col ) {
+  for( uint16_t i = d->up[col]; i != col; i = d->up[i] ) { uncover_row(d, i); }
+  d->size[col] &= ~DLX_COVERED;
+}
+
+// puts a row in the soln: covers the columns of its other nodes
+static void select_row( dlx_state *d, uint16_t node ) {
+  for( int k=1; k<4; ++k ) { cover(d, node_col(d, node_next(node, k))); }
+}
+
+// undoes select_row(), in reverse
+static void unselect_row( dlx_state *d, uint16_t node ) {
+  for( int k=3; k>0; --k ) { uncover(d, node_col(d, node_next(node, k))); }
+}
+
+// builds the matrix for the empty squares of a puzzle
+// false --> givens clash
+static bool build( dlx_state *d, const uint8_t *cells, bool *too_big ) {
+  *too_big = false;
+
+  solver_state s;
+  if( !solver_load(&s, cells) ) { return false; }
+
+  for( int c=0; c<DLX_COLS; ++c ) {
+    d->up[c] = c;
+    d->down[c] = c;
+    d->size[c] = 0;
+  }
+  d->rows = 0;
+
+  for( int row=0; row<9; ++row ) {
+    for( int col=0; col<9; ++col ) {
+      int cell = row*9 + col;
+      uint8_t given = cells[cell];
+
+      // constraints met by a given are left out of the search
+      if(given != 0) {
+        d->size[cell] = DLX_COVERED;
+        d->size[81 + row*9 + given - 1] = DLX_COVERED;
+        d->size[162 + col*9 + given - 1] = DLX_COVERED;
+        d->size[243 + solver_box(row, col)*9 + given - 1] = DLX_COVERED;
+        continue;
+      }
+
+      for( uint16_t cand = solver_candidates(&s, row, col); cand; cand &= cand - 1 ) {
+        if(d->rows == DLX_MAX_ROWS) {
+          *too_big = true;
+          return false;
+        }
+        int r = d->rows++;
+        d->row_cell[r] = cell;
+        d->row_value[r] = solver_value(cand);
+
+        uint16_t first = DLX_COLS + 4*r;
+        for( int k=0; k<4; ++k ) { link_node(d, first + k, node_col(d, first + k)); }
+      }
+    }
+  }
+  return true;
+}
+
+// uncovered column with the fewest rows, -1 if all are covered
+static int choose( const dlx_state *d ) {
+  int best = -1;
+  uint8_t best_size = DLX_COVERED;
+  for( int c=0; c<DLX_COLS; ++c ) {
+    if(d->size[c] < best_size) {
+      best = c;
+      best_size = d->size[c];
+      if(best_size == 0) { break; }
+    }
+  }
+  return best;
+}
+
+int dlx_count( dlx_state *d, const uint8_t *cells, int limit, uint8_t *soln ) {
+  bool too_big;
+  if( !build(d, cells, &too_big) ) { return too_big ? DLX_TOO_BIG : 0; }
+
+  uint16_t choice[81]; // row node picked at each level
+  int k = 0;
+  int count = 0;
+
+  // iterative instead of recursive so the Mega's stack stays small
+  while(true) {
+    int col = choose(d);
+
+    // every constraint met --> soln
+    if(col < 0) {
+      if(count == 0 && soln) {
+        for( int i=0; i<81; ++i ) { soln[i] = cells[i]; }
+        for( int i=0; i<k; ++i ) {
+          int r = (choice[i] - DLX_COLS) >> 2;
+          soln[ d->row_cell[r] ] = d->row_value[r];
+        }
+      }
+      if(++count >= limit) { return count; }
+    }
+    // pick the first row of the column
+    else if(d->size[col] > 0) {
+      cover(d, col);
+      choice[k] = d->down[col];
+      select_row(d, choice[k]);
+      k++;
+      continue;
+    }
+
+    // dead end or soln counted --> try the next row of the last column
+    while(true) {
+      if(k == 0) { return count; }
+      k--;
+      unselect_row(d, choice[k]);
+      uint16_t c = node_col(d, choice[k]);
+      choice[k] = d->down[ choice[k] ];
+      if(choice[k] != c) {
+        select_row(d, choice[k]);
+        k++;
+        break;
+      }
+      uncover(d, c);
+    }
+  }
+}
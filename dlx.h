@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dancing Links (Algorithm X) exact cover solver
+//
+// the standard sudoku matrix: 324 columns, one per constraint
+//   0 to 80    --> square (row, col) has a value
+//   81 to 161  --> row has value n
+//   162 to 242 --> col has value n
+//   243 to 323 --> box has value n
+// and one row of 4 nodes per (square, value) candidate. only candidates
+// left by the givens are added, so the node pool can be much smaller than
+// the full 729 rows.
+//
+// the pool is fixed size and lives in dlx_state, no allocation.
+// on the Mega it is sized to stay near 4.5K of SRAM, puzzles that need
+// more rows than that report DLX_TOO_BIG so the caller can fall back to
+// the bitmask solver.
+//
+// the game's own globals take about 3.5K of the Mega's 8K, so the pool
+// and the game do not fit together: USE_DLX is for the host tools only
+// on this build. the game checks uniqueness with the bitmask solver.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef DLX_H
+#define DLX_H
+
+#include<stdint.h>
+
+#define DLX_COLS 324
+
+#ifndef DLX_MAX_ROWS
+#ifdef __AVR__
+#define DLX_MAX_ROWS 160 // (324 + 4*160)*4 + 324 + 2*160 bytes
+#else
+#define DLX_MAX_ROWS 729 // every (square, value) pair
+#endif
+#endif
+
+#define DLX_NODES (DLX_COLS + 4*DLX_MAX_ROWS)
+#define DLX_TOO_BIG -1
+
+struct dlx_state {
+  // vertical links. nodes 0 to 323 are the column headers,
+  // row r owns nodes DLX_COLS + 4*r to DLX_COLS + 4*r + 3
+  uint16_t up[DLX_NODES];
+  uint16_t down[DLX_NODES];
+  // rows left in each column, high bit set once covered.
+  // columns are picked by scanning this instead of keeping a header
+  // ring, which saves 1.3K of SRAM on the Mega
+  uint8_t size[DLX_COLS];
+  uint8_t row_cell[DLX_MAX_ROWS];  // square index of each row
+  uint8_t row_value[DLX_MAX_ROWS]; // value 1 to 9 of each row
+  int rows;
+};
+
+// counts solns of 81 values (0 == empty), stopping once limit are found
+// returns 0, 1 ... limit, or DLX_TOO_BIG if the pool can't hold the puzzle
+// soln (may be NULL) gets the first soln found
+int dlx_count( dlx_state *d, const uint8_t *cells, int limit, uint8_t *soln );
+
+#endif
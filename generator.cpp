@@ -0,0 +1,345 @@
+#include<stddef.h>
+
+#include "generator.h"
+#include "solver.h"
+#include "dlx.h"
+#include "probe.h"
+
+void gen_init( gen_state *g, uint32_t seed ) {
+  board_clear(&g->soln);
+  board_clear(&g->puzzle);
+  rng_seed(&g->rng, seed);
+  g->step = GEN_IDLE;
+  g->strikes = 0;
+  g->struck = 0;
+  gen_reset_stats(g);
+}
+
+// 0 to n-1
+static int gen_random( gen_state *g, int n ) { return (int)rng_range(&g->rng, n); }
+
+// complete grids to transform, in flash on the Mega. the first is the
+// vanilla sudoku, the rest are the solns of well known hard puzzles, so
+// they are not transforms of each other
+#define GEN_SEEDS 8
+static const uint8_t gen_seeds[GEN_SEEDS][81] PROGMEM = {
+  {
+    1,2,3,4,5,6,7,8,9,
+    4,5,6,7,8,9,1,2,3,
+    7,8,9,1,2,3,4,5,6,
+    2,3,4,5,6,7,8,9,1,
+    5,6,7,8,9,1,2,3,4,
+    8,9,1,2,3,4,5,6,7,
+    3,4,5,6,7,8,9,1,2,
+    6,7,8,9,1,2,3,4,5,
+    9,1,2,3,4,5,6,7,8
+  },
+  {
+    5,3,4,6,7,8,9,1,2,
+    6,7,2,1,9,5,3,4,8,
+    1,9,8,3,4,2,5,6,7,
+    8,5,9,7,6,1,4,2,3,
+    4,2,6,8,5,3,7,9,1,
+    7,1,3,9,2,4,8,5,6,
+    9,6,1,5,3,7,2,8,4,
+    2,8,7,4,1,9,6,3,5,
+    3,4,5,2,8,6,1,7,9
+  },
+  {
+    8,5,9,6,1,2,4,3,7,
+    7,2,3,8,5,4,1,6,9,
+    1,6,4,3,7,9,5,2,8,
+    9,8,6,1,4,7,3,5,2,
+    3,7,5,2,6,8,9,1,4,
+    2,4,1,5,9,3,7,8,6,
+    4,3,2,9,8,1,6,7,5,
+    6,1,7,4,2,5,8,9,3,
+    5,9,8,7,3,6,2,4,1
+  },
+  {
+    1,4,5,3,2,7,6,9,8,
+    8,3,9,6,5,4,1,2,7,
+    6,7,2,9,1,8,5,4,3,
+    4,9,6,1,8,5,3,7,2,
+    2,1,8,4,7,3,9,5,6,
+    7,5,3,2,9,6,4,8,1,
+    3,6,7,5,4,2,8,1,9,
+    9,8,4,7,6,1,2,3,5,
+    5,2,1,8,3,9,7,6,4
+  },
+  {
+    1,2,8,5,4,7,6,3,9,
+    3,4,5,8,6,9,2,1,7,
+    6,7,9,2,1,3,5,4,8,
+    9,1,2,4,8,6,3,7,5,
+    7,8,4,3,5,2,1,9,6,
+    5,3,6,7,9,1,4,8,2,
+    8,9,1,6,2,4,7,5,3,
+    4,6,7,9,3,5,8,2,1,
+    2,5,3,1,7,8,9,6,4
+  },
+  {
+    6,2,4,5,7,8,1,3,9,
+    1,3,5,4,9,6,8,2,7,
+    7,8,9,1,2,3,4,5,6,
+    2,1,6,3,8,5,7,9,4,
+    8,5,7,9,6,4,2,1,3,
+    4,9,3,2,1,7,6,8,5,
+    9,4,2,6,5,1,3,7,8,
+    5,6,8,7,3,2,9,4,1,
+    3,7,1,8,4,9,5,6,2
+  },
+  {
+    7,9,6,1,5,2,3,8,4,
+    5,3,1,4,6,8,9,2,7,
+    4,2,8,3,7,9,6,5,1,
+    1,5,2,6,3,4,7,9,8,
+    3,8,4,7,9,1,2,6,5,
+    9,6,7,2,8,5,1,4,3,
+    2,1,9,8,4,3,5,7,6,
+    6,4,5,9,1,7,8,3,2,
+    8,7,3,5,2,6,4,1,9
+  },
+  {
+    1,6,2,8,5,7,4,9,3,
+    5,3,4,1,2,9,6,7,8,
+    7,8,9,6,4,3,5,2,1,
+    4,7,5,3,1,2,9,8,6,
+    9,1,3,5,8,6,7,4,2,
+    6,2,8,7,9,4,1,3,5,
+    3,5,6,4,7,8,2,1,9,
+    2,4,1,9,3,5,8,6,7,
+    8,9,7,2,6,1,3,5,4
+  }
+};
+
+// the 6 orders of 3 rows, cols, bands or stacks
+static const uint8_t perm3[6][3] PROGMEM = {
+  {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0}
+};
+
+// 6^8 ways to order the lines: 6^4 for the bands and the rows within each,
+// 6^4 for the stacks and the cols within each
+#define GEN_LINE_ORDERS 1679616ul
+// 9! ways to relabel the values
+#define GEN_RELABELS 362880ul
+
+// the k-th of the orders packed in *x, which loses them
+static void unpack_lines( uint32_t *x, uint8_t *line ) {
+  uint8_t outer = *x % 6;
+  *x /= 6;
+  for( int b=0; b<3; ++b ) {
+    uint8_t inner = *x % 6;
+    *x /= 6;
+    for( int k=0; k<3; ++k ) {
+      line[b*3 + k] = pgm_read_byte(&perm3[outer][b]) * 3 + pgm_read_byte(&perm3[inner][k]);
+    }
+  }
+}
+
+// picks one transform out of the whole symmetry group of sudoku: a seed
+// grid, an order of the bands, of the rows within each band, of the
+// stacks and of the cols within each stack, a transpose and a relabeling
+// of the values. that is 3 random numbers, then every square is copied
+// once through the index it comes from
+void generate_grid( gen_state *g ) {
+  uint32_t x = rng_range(&g->rng, GEN_LINE_ORDERS);
+  uint8_t row[9], col[9]; // row and col of the seed each one comes from
+  unpack_lines(&x, row); // 6^4 of them
+  unpack_lines(&x, col); // the other 6^4
+
+  // relabel[n] replaces n, drawn one value at a time from those left
+  uint8_t relabel[10];
+  uint8_t left[9] = { 1,2,3,4,5,6,7,8,9 };
+  x = rng_range(&g->rng, GEN_RELABELS);
+  for( int n=1; n<=9; ++n ) {
+    int k = x % (10 - n);
+    x /= 10 - n;
+    relabel[n] = left[k];
+    left[k] = left[9 - n]; // last one left takes its place
+  }
+
+  x = rng_range(&g->rng, GEN_SEEDS * 2);
+  const uint8_t *seed = gen_seeds[x >> 1];
+  bool transpose = x & 1;
+
+  uint8_t soln[81];
+  for( uint8_t i=0; i<81; ++i ) {
+    uint8_t r = row[board_row(i)], c = col[board_col(i)];
+    uint8_t from = transpose ? c*9 + r : r*9 + c;
+    soln[i] = relabel[pgm_read_byte(&seed[from])];
+  }
+  board_load(&g->soln, soln);
+}
+
+// work on a plain copy of the soln, 0 == stroke out. squares are tried
+// in a shuffled order, first as symmetric pairs, then one at a time
+static void reduce_start( gen_state *g, int strikes ) {
+  board_unpack(&g->soln, g->work);
+  solver_load(&g->base, g->work);
+  for( uint8_t i=0; i<81; ++i ) {
+    uint8_t k = gen_random(g, i + 1);
+    g->order[i] = g->order[k];
+    g->order[k] = i;
+  }
+  for( int k=0; k<11; ++k ) { g->forced[k] = 0; }
+
+  g->strikes = (strikes > 0) ? strikes : 0;
+  g->struck = 0;
+  g->idx = 0;
+  g->checks = 0;
+  g->step = GEN_PAIRS;
+}
+
+// stroke out squares are no longer fixed
+static void reduce_finish( gen_state *g ) {
+  board_load(&g->puzzle, g->work);
+  g->stats.puzzles++;
+  g->stats.checks += g->checks;
+  if(g->checks > g->stats.max_checks) { g->stats.max_checks = g->checks; }
+  g->step = GEN_DONE;
+}
+
+static bool is_forced( const gen_state *g, uint8_t i ) { return (g->forced[i >> 3] >> (i & 7)) & 1; }
+
+#ifndef USE_DLX
+// true if s has a soln with square i other than n
+static bool other_soln( const solver_state *s, uint8_t i, uint8_t n ) {
+  uint8_t row = board_row(i), col = board_col(i);
+  uint16_t cand = solver_candidates(s, row, col) & ~solver_bit(n);
+  while(cand) {
+    uint16_t bit = cand & -cand;
+    cand &= ~bit;
+    solver_state t = *s;
+    solver_place(&t, row, col, solver_value(bit));
+    if( solver_count_solutions(&t, 1) ) { return true; }
+  }
+  return false;
+}
+#endif
+
+// strikes out squares i and j (the same square for one) if the soln
+// stays unique. the puzzle had one soln, g->soln, so any other soln
+// differs from it on i or j: look only for those, and only for one
+static bool try_strike( gen_state *g, uint8_t i, uint8_t j ) {
+  uint8_t vi = g->work[i], vj = g->work[j];
+  g->checks++;
+  PROBE_INC(PROBE_UNIQUE_CHECKS);
+
+#ifdef USE_DLX
+  g->work[i] = g->work[j] = 0;
+  bool unique = test_unique(g->work);
+  g->work[i] = vi;
+  g->work[j] = vj;
+  if(!unique) { return false; }
+#else
+  solver_state s = g->base;
+  solver_remove(&s, board_row(i), board_col(i));
+  if(j != i) { solver_remove(&s, board_row(j), board_col(j)); }
+  if( other_soln(&s, i, vi) ) { return false; }
+  if(j != i) {
+    solver_place(&s, board_row(i), board_col(i), vi);
+    if( other_soln(&s, j, vj) ) { return false; }
+  }
+#endif
+
+  solver_remove(&g->base, board_row(i), board_col(i));
+  if(j != i) { solver_remove(&g->base, board_row(j), board_col(j)); }
+  g->work[i] = g->work[j] = 0;
+  return true;
+}
+
+// strikes out squares while maintaining uniqueness
+void reduce_grid( gen_state *g, int strikes ) {
+  reduce_start(g, strikes);
+  while( !gen_step(g) ) {}
+}
+
+void gen_puzzle( gen_state *g, int strikes ) {
+  generate_grid(g);
+  reduce_grid(g, strikes);
+}
+
+void gen_start( gen_state *g, int strikes ) {
+  generate_grid(g);
+  reduce_start(g, strikes);
+}
+
+bool gen_step( gen_state *g ) {
+  while(g->step == GEN_PAIRS || g->step == GEN_SINGLES) {
+    if(g->struck >= g->strikes) { reduce_finish(g); break; }
+
+    // end of the order: pairs are followed by singles, then every
+    // square left is forced and the puzzle is minimal
+    if(g->idx == 81) {
+      if(g->step == GEN_SINGLES) { reduce_finish(g); break; }
+      g->step = GEN_SINGLES;
+      g->idx = 0;
+    }
+
+    uint8_t i = g->order[g->idx++];
+    uint8_t j = i;
+    if(g->step == GEN_PAIRS) {
+      if(i > 40) { continue; } // pairs are taken from their first square
+      j = 80 - i; // i itself for the centre
+      if(j != i && g->struck + 2 > g->strikes) { continue; }
+    }
+    if(g->work[i] == 0 || g->work[j] == 0) { continue; }
+
+    // a square that had to stay still has to with fewer givens
+    if( is_forced(g, i) || is_forced(g, j) ) {
+      g->stats.skipped++;
+      continue;
+    }
+
+    if( try_strike(g, i, j) ) {
+      g->struck += (j == i) ? 1 : 2;
+      if(j != i) { g->stats.pairs++; }
+    }
+    else if(j == i) { g->forced[i >> 3] |= 1 << (i & 7); }
+    break; // one check per slice
+  }
+  return g->step == GEN_DONE;
+}
+
+void gen_cancel( gen_state *g ) {
+  g->step = GEN_IDLE;
+}
+
+// the further of the strikes done and the order walked
+int gen_progress( const gen_state *g, int scale ) {
+  if(g->step == GEN_DONE) { return scale; }
+  if(g->step == GEN_IDLE || g->strikes == 0) { return 0; }
+  int walked = (g->step == GEN_SINGLES ? 81 + g->idx : g->idx) * scale / 162;
+  int struck = (int)g->struck * scale / g->strikes;
+  return walked > struck ? walked : struck;
+}
+
+void gen_reset_stats( gen_state *g ) {
+  g->stats.puzzles = 0;
+  g->stats.checks = 0;
+  g->stats.max_checks = 0;
+  g->stats.pairs = 0;
+  g->stats.skipped = 0;
+}
+
+#ifdef USE_DLX
+// one node pool, static so the link map counts it. one per thread on the
+// host, as the generators are
+#ifdef __AVR__
+static dlx_state dlx_pool;
+#else
+static thread_local dlx_state dlx_pool;
+#endif
+#endif
+
+bool test_unique( const uint8_t *cells ) {
+#ifdef USE_DLX
+  // count solns with Dancing Links
+  // falls through to the bitmask solver if the node pool is too small
+  int solns = dlx_count(&dlx_pool, cells, 2, NULL);
+  if(solns != DLX_TOO_BIG) { return solns == 1; }
+#endif
+
+  return count_solutions(cells, 2) == 1;
+}
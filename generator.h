@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// puzzle generator
+//
+// > pick one of a few complete seed grids
+// > apply a random transform from the whole symmetry group: relabel the
+//   values, reorder bands, stacks, and the rows and cols within them,
+//   maybe transpose. each is a valid grid again
+// > strike out squares while the soln stays unique: symmetric pairs
+//   first, one check for two squares, then single squares, in a shuffled
+//   order. a square whose removal broke uniqueness is never tried again,
+//   fewer givens cannot make it unneeded
+//
+// all state lives in gen_state, so several generators can run at once
+// (one per thread on the host). random numbers come from the seeded rng in
+// gen_state, so a seed always gives the same puzzles.
+//
+// striking out squares takes one uniqueness check per try, too long to
+// do at once on the arduino. gen_start() and gen_step() do it in slices
+// of one check, so the caller can keep the screen and joystick going.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include<stdint.h>
+
+#include "board.h"
+#include "rng.h"
+#include "solver.h"
+
+// squares struck out for each difficulty
+#define GEN_EASY   (81 - 35)
+#define GEN_MEDIUM (81 - 30)
+#define GEN_HARD   (81 - 25)
+#define GEN_MINIMAL 81 // strike out until no given can go
+
+// gen_state.step
+#define GEN_IDLE 0 // nothing started or cancelled
+#define GEN_PAIRS   1 // try order[idx] with its mirror square
+#define GEN_SINGLES 2 // try order[idx] alone
+#define GEN_DONE 3 // g->puzzle is ready
+
+// reducer counters since gen_init() or gen_reset_stats()
+struct gen_stats {
+  uint32_t puzzles;    // puzzles finished
+  uint32_t checks;     // uniqueness checks for them
+  uint16_t max_checks; // most checks for one puzzle
+  uint32_t pairs;      // checks that struck out a symmetric pair
+  uint32_t skipped;    // tries skipped, the square was known to be forced
+};
+
+struct gen_state {
+  board soln;   // complete grid
+  board puzzle; // soln with squares struck out, givens are fixed
+  rng_state rng;
+
+  // puzzle being reduced by gen_step()
+  uint8_t work[81];   // 0 == stroke out
+  solver_state base;  // work loaded, masks kept in step with it
+  uint8_t order[81];  // squares in the order they are tried
+  uint8_t forced[11]; // bit per square: it has to stay a given
+  uint8_t step;       // GEN_IDLE etc.
+  uint8_t strikes;    // squares to strike out
+  uint8_t struck;     // squares stroke out so far
+  uint8_t idx;        // next place in order
+  uint16_t checks;    // uniqueness checks for this puzzle
+  gen_stats stats;
+};
+
+void gen_init( gen_state *g, uint32_t seed );
+
+// fills g->soln with a new complete grid
+void generate_grid( gen_state *g );
+
+// copies g->soln into g->puzzle and strikes out up to strikes squares
+// while maintaining uniqueness. stops early if no square can go, so
+// GEN_MINIMAL gives a minimal puzzle
+void reduce_grid( gen_state *g, int strikes );
+
+// generate_grid() then reduce_grid()
+void gen_puzzle( gen_state *g, int strikes );
+
+// same as gen_puzzle(), in slices: gen_start() makes the grid, then each
+// gen_step() does at most one uniqueness check. gen_step() returns true
+// once g->puzzle is ready. a seed gives the same puzzles either way
+void gen_start( gen_state *g, int strikes );
+bool gen_step( gen_state *g );
+
+// stops a puzzle started with gen_start()
+void gen_cancel( gen_state *g );
+
+// share of the puzzle done, 0 to scale
+int gen_progress( const gen_state *g, int scale );
+
+void gen_reset_stats( gen_state *g );
+
+// counts solns of a puzzle, stopping at 2
+// true ---> exactly one soln i.e. solution is unique
+// false --> no soln or more than one
+bool test_unique( const uint8_t *cells );
+
+#endif
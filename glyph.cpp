@@ -0,0 +1,128 @@
+#include<string.h>
+
+#include "glyph.h"
+#include "board.h" // PROGMEM on the Mega
+
+#define BLACK 0x0000
+#define WHITE 0xFFFF
+#define RED   0xF800 // hal_color(0xff, 0x00, 0x00)
+#define YELLOW 0xFFE0 // hal_color(0xff, 0xff, 0x00)
+#define GREEN 0x07E0 // hal_color(0x00, 0xff, 0x00)
+#define GREY  0x8410 // hal_color(0x80, 0x80, 0x80)
+
+// columns of blank and the digits '1' to '9' from the 5x7 font
+// drawChar() uses, bit 0 at the top
+constexpr uint8_t glyph_font[10][5] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0x00, 0x42, 0x7F, 0x40, 0x00 }, { 0x72, 0x49, 0x49, 0x49, 0x46 },
+  { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+  { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 },
+  { 0x41, 0x21, 0x11, 0x09, 0x07 }, { 0x36, 0x49, 0x49, 0x49, 0x36 },
+  { 0x46, 0x49, 0x49, 0x29, 0x1E }
+};
+
+// bit x of line y of a square is set where the value is drawn
+// font column i lands on x = 5 + i, font row j on y = 4 + j
+constexpr uint16_t glyph_bit( int n, int i, int y ) {
+  return (y >= 4 && y <= 11 && ((glyph_font[n][i] >> (y - 4)) & 1)) ? (1 << (5 + i)) : 0;
+}
+constexpr uint16_t glyph_row( int n, int y ) {
+  return glyph_bit(n, 0, y) | glyph_bit(n, 1, y) | glyph_bit(n, 2, y) |
+         glyph_bit(n, 3, y) | glyph_bit(n, 4, y);
+}
+
+#define GLYPH(n) { glyph_row(n, 0), glyph_row(n, 1), glyph_row(n, 2), glyph_row(n, 3), \
+                   glyph_row(n, 4), glyph_row(n, 5), glyph_row(n, 6), glyph_row(n, 7), \
+                   glyph_row(n, 8), glyph_row(n, 9), glyph_row(n, 10), glyph_row(n, 11), \
+                   glyph_row(n, 12), glyph_row(n, 13) }
+
+// worked out by the compiler, kept in flash on the Mega
+constexpr uint16_t glyph_masks[10][GLYPH_SIZE] PROGMEM = {
+  GLYPH(0), GLYPH(1), GLYPH(2), GLYPH(3), GLYPH(4),
+  GLYPH(5), GLYPH(6), GLYPH(7), GLYPH(8), GLYPH(9)
+};
+
+// 3x3 digits '1' to '9' for notes, a row each, bit 0 on the left
+constexpr uint8_t note_font[9][3] = {
+  { 2, 2, 2 }, { 3, 2, 6 }, { 7, 6, 7 }, { 5, 7, 4 }, { 6, 2, 3 },
+  { 1, 7, 7 }, { 7, 4, 4 }, { 7, 5, 7 }, { 7, 7, 4 }
+};
+
+// line gy (0 to 2) of the notes of slot row s, values 3s+1 to 3s+3, of
+// which bits holds the ones noted. digit k is at x = 4k
+constexpr uint16_t note_bits( int s, int bits, int gy ) {
+  return (((bits >> 0) & 1) ? note_font[3*s + 0][gy] << 0 : 0) |
+         (((bits >> 1) & 1) ? note_font[3*s + 1][gy] << 4 : 0) |
+         (((bits >> 2) & 1) ? note_font[3*s + 2][gy] << 8 : 0);
+}
+
+#define NOTE_ROW(s, b) { note_bits(s, b, 0), note_bits(s, b, 1), note_bits(s, b, 2) }
+#define NOTE_SLOTS(s) { NOTE_ROW(s, 0), NOTE_ROW(s, 1), NOTE_ROW(s, 2), NOTE_ROW(s, 3), \
+                        NOTE_ROW(s, 4), NOTE_ROW(s, 5), NOTE_ROW(s, 6), NOTE_ROW(s, 7) }
+
+// every line of every set of notes on a slot row, 144 bytes of flash
+constexpr uint16_t note_masks[3][8][3] PROGMEM = { NOTE_SLOTS(0), NOTE_SLOTS(1), NOTE_SLOTS(2) };
+
+void glyph_notes( uint16_t *px, uint16_t notes, uint8_t y, uint8_t x0, uint8_t y0 ) {
+  if(y < y0) { return; }
+  uint8_t s = (y - y0) >> 2, gy = (y - y0) & 3;
+  if(s > 2 || gy == 3) { return; }
+
+  uint16_t mask = pgm_read_word( &note_masks[s][(notes >> (3*s)) & 7][gy] ) << x0;
+  for( int x=1; x<GLYPH_SIZE - 1; ++x ) {
+    if((mask >> x) & 1) { px[x] = GREY; }
+  }
+}
+
+// colours line y of glyph g from its mask
+static void mask_line( uint16_t *px, uint8_t g, uint8_t outline, uint8_t y ) {
+  uint16_t edge = WHITE;
+  if(outline == GLYPH_CURSOR) { edge = RED; }
+  else if(outline == GLYPH_HINT) { edge = GREEN; }
+
+  if(y == 0 || y == GLYPH_SIZE - 1) {
+    for( int x=0; x<GLYPH_SIZE; ++x ) { px[x] = edge; }
+    return;
+  }
+
+  uint16_t fg = WHITE;
+  if(g > 18) {
+    fg = YELLOW;
+    g -= 18;
+  }
+  else if(g > 9) {
+    fg = RED;
+    g -= 9;
+  }
+  uint16_t mask = pgm_read_word( &glyph_masks[g][y] );
+
+  px[0] = edge;
+  for( int x=1; x<GLYPH_SIZE - 1; ++x ) { px[x] = ((mask >> x) & 1) ? fg : BLACK; }
+  px[GLYPH_SIZE - 1] = edge;
+}
+
+#ifdef __AVR__
+
+void glyph_line( uint16_t *px, uint8_t g, uint8_t edge, uint8_t y ) {
+  mask_line(px, g, edge, y);
+}
+
+#else
+
+// every glyph with every outline, rendered on first use
+static uint16_t cache[GLYPH_EDGES][GLYPHS][GLYPH_SIZE][GLYPH_SIZE];
+static bool cache_ready = false;
+
+void glyph_line( uint16_t *px, uint8_t g, uint8_t edge, uint8_t y ) {
+  if(!cache_ready) {
+    for( int c=0; c<GLYPH_EDGES; ++c ) {
+      for( int i=0; i<GLYPHS; ++i ) {
+        for( int j=0; j<GLYPH_SIZE; ++j ) { mask_line(cache[c][i][j], i, c, j); }
+      }
+    }
+    cache_ready = true;
+  }
+  memcpy(px, cache[edge][g][y], sizeof(cache[0][0][0]));
+}
+
+#endif
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// pre-rendered board squares
+//
+// a 14x14 square is its outline (white, red under the cursor, green on
+// the squares a hint follows from, see hint.h) around a 6x8 value at
+// (5, 4): blank, 1 to 9 in white, 1 to 9 in red if fixed, or 1 to 9 in
+// yellow if it clashes with another square (see check.h).
+// glyph_line() writes one line of such a square, ready for
+// hal_push_pixels(). the 3x3 box lines depend on where the square is,
+// so they are not part of the glyph (see render.cpp).
+//
+// an empty square can show the player's notes (see notes.h) instead: a
+// 3x3 grid of grey 3x3 digits, value n in slot (n-1)%3, (n-1)/3, 4 pixels
+// apart. glyph_notes() draws them over a line of a blank glyph from a
+// table of every line of every set of three notes, 144 bytes of flash.
+//
+// the Mega keeps 14-bit masks of each value in flash, 280 bytes, and
+// colours a line from its mask. the host renders all 84 squares to RGB565
+// once, 33KB, and copies lines straight out of that cache.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#include<stdint.h>
+
+#define GLYPH_SIZE 14
+
+// glyph of a square: 0 == blank, 1 to 9 white, 10 to 18 red (fixed),
+// 19 to 27 yellow (clash). a fixed value stays red, the player's is wrong
+#define GLYPHS 28
+inline uint8_t glyph_index( uint8_t n, bool fixed, bool conflict ) {
+  if(n == 0) { return 0; }
+  if(fixed) { return n + 9; }
+  return conflict ? n + 18 : n;
+}
+
+// outline of a square
+#define GLYPH_PLAIN  0
+#define GLYPH_CURSOR 1
+#define GLYPH_HINT   2
+#define GLYPH_EDGES  3
+
+// writes the 14 pixels of line y (0 to 13) of glyph g with outline edge
+void glyph_line( uint16_t *px, uint8_t g, uint8_t edge, uint8_t y );
+
+// draws line y of notes (bit n-1 == value n) over px, the slots starting
+// at x0, y0 (1 or 2, clear of the box lines)
+void glyph_notes( uint16_t *px, uint16_t notes, uint8_t y, uint8_t x0, uint8_t y0 );
+
+#endif
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// hardware abstraction layer
+//
+// everything the game needs from the board goes through here:
+// display, joystick, random noise, clock, serial, the SD card and a
+// small save area that keeps its bytes without power.
+//
+// hal_arduino.cpp   --> Mega with the ST7735 screen and thumb joystick
+// host/hal_linux.cpp --> headless framebuffer and scripted joystick, for
+//                        running the game under perf and sanitizers
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef HAL_H
+#define HAL_H
+
+#include<stdint.h>
+
+//dimensions of LCD screen
+#define TFT_WIDTH 128
+#define TFT_HEIGHT 160
+
+// joystick axes for hal_joy_read()
+#define JOY_VERT 0
+#define JOY_HORZ 1
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// starts serial, screen and joystick
+void hal_init();
+
+// 16-bit 565 colour, same as Adafruit_ST7735::Color565()
+inline uint16_t hal_color( uint8_t r, uint8_t g, uint8_t b ) {
+  return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// display, same meaning as the Adafruit_GFX calls of the same name
+void hal_fill_screen( uint16_t color );
+void hal_draw_rect( int x, int y, int w, int h, uint16_t color );
+void hal_fill_rect( int x, int y, int w, int h, uint16_t color );
+void hal_draw_char( int x, int y, char ch, uint16_t fg, uint16_t bg, uint8_t size );
+// prints str with its top left corner at (x, y)
+void hal_text( int x, int y, uint8_t size, uint16_t fg, uint16_t bg, const char *str );
+
+// bulk drawing: hal_window() selects a w x h window, then hal_push_pixels()
+// fills it left to right, top to bottom, in as many pieces as needed.
+// one address window and one stream of pixels instead of a transaction
+// per rectangle or character
+void hal_window( int x, int y, int w, int h );
+void hal_push_pixels( const uint16_t *pixels, int n );
+
+// joystick
+int hal_joy_read( int axis ); // 0 to 1023, about 512 at rest
+bool hal_joy_pressed();       // true while the stick is pushed in
+
+// one random bit from analog noise
+int hal_noise();
+
+// clock
+unsigned long hal_millis();
+unsigned long hal_micros();
+void hal_delay( unsigned long ms );
+
+// calls fn every period ms (1 to 255), one fn at a time. on the Mega from
+// a timer interrupt, so fn must be short and share only volatile state.
+// host: as hal_delay() moves the virtual clock
+void hal_timer( void (*fn)(), uint8_t period );
+
+// serial
+void hal_serial_print( const char *str );
+void hal_serial_char( char ch );
+void hal_serial_number( uint32_t n ); // in decimal
+
+// one read-only file on the SD card (host: $SUDOKU_BANK if set)
+// false --> no card or no such file
+bool hal_sd_open( const char *name );
+// n bytes at pos of the open file, one seek and one read
+// false --> no file open or past its end
+bool hal_sd_read( uint32_t pos, uint8_t *buf, uint16_t n );
+
+// save area: EEPROM on the Mega (4KB), host: the file $SUDOKU_SAVE if set
+// false --> no save area, or past its end
+bool hal_save_read( uint16_t pos, uint8_t *buf, uint16_t n );
+void hal_save_write( uint16_t pos, const uint8_t *buf, uint16_t n );
+
+#endif
@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+// hal.h for the Arduino Mega, see README.txt for the wiring
+///////////////////////////////////////////////////////////////////////////////
+
+#include<Arduino.h> // arduino library
+
+#include<Adafruit_GFX.h>    // Core graphics library
+#include<Adafruit_ST7735.h> // Hardware-specific library
+#include<SPI.h>
+#include<SD.h>
+#include<EEPROM.h>
+
+#include "hal.h"
+
+#define TFT_RST 8 // Reset line for TFT (or connect to +5V)
+#define TFT_DC  7 // Data/command line for TFT
+#define SD_CS   5 // Chip select line for SD card
+#define TFT_CS  6 // Chip select line for TFT display
+
+Adafruit_ST7735 tft = Adafruit_ST7735( TFT_CS, TFT_DC, TFT_RST );
+
+#define JOY_VERT_ANALOG 0
+#define JOY_HORZ_ANALOG 1
+#define JOY_SEL 9
+
+#define NOISE_ANALOG 7 // analog pin 7 should not be connected to anything
+
+void hal_init() {
+  init();
+  Serial.begin(9600);        // initialize serial communication
+  tft.initR(INITR_BLACKTAB);
+
+  pinMode( JOY_SEL, INPUT );     // Init joystick
+  digitalWrite( JOY_SEL, HIGH ); // enables pull-up resistor
+}
+
+void hal_fill_screen( uint16_t color ) { tft.fillScreen(color); }
+
+void hal_draw_rect( int x, int y, int w, int h, uint16_t color ) {
+  tft.drawRect(x, y, w, h, color);
+}
+
+void hal_fill_rect( int x, int y, int w, int h, uint16_t color ) {
+  tft.fillRect(x, y, w, h, color);
+}
+
+void hal_draw_char( int x, int y, char ch, uint16_t fg, uint16_t bg, uint8_t size ) {
+  tft.drawChar(x, y, ch, fg, bg, size);
+}
+
+void hal_text( int x, int y, uint8_t size, uint16_t fg, uint16_t bg, const char *str ) {
+  tft.setTextSize(size);
+  tft.setTextColor(fg, bg);
+  tft.setCursor(x, y);
+  tft.print(str);
+}
+
+void hal_window( int x, int y, int w, int h ) {
+  tft.setAddrWindow(x, y, x + w - 1, y + h - 1); // ends with RAMWR
+}
+
+// pushColor() selects the chip for every pixel, so write to SPI directly
+// for the whole piece
+void hal_push_pixels( const uint16_t *pixels, int n ) {
+  SPI.beginTransaction( SPISettings(8000000, MSBFIRST, SPI_MODE0) );
+  digitalWrite(TFT_DC, HIGH); // data
+  digitalWrite(TFT_CS, LOW);
+  for( int i=0; i<n; ++i ) {
+    SPI.transfer(pixels[i] >> 8);
+    SPI.transfer(pixels[i] & 0xFF);
+  }
+  digitalWrite(TFT_CS, HIGH);
+  SPI.endTransaction();
+}
+
+int hal_joy_read( int axis ) {
+  if(axis == JOY_VERT) { return analogRead(JOY_VERT_ANALOG); }
+  return analogRead(JOY_HORZ_ANALOG);
+}
+
+bool hal_joy_pressed() { return digitalRead(JOY_SEL) == LOW; }
+
+int hal_noise() {
+  int val = analogRead(NOISE_ANALOG); // analog pin 7 voltage fluctuates
+  delay(10); // wait for 10ms to allow for voltage fluctuation
+  return val & 1; // least significant bit
+}
+
+unsigned long hal_millis() { return millis(); }
+unsigned long hal_micros() { return micros(); }
+void hal_delay( unsigned long ms ) { delay(ms); }
+
+static void (*timer_fn)() = NULL;
+static uint8_t timer_period = 1;
+static uint8_t timer_ticks = 0;
+
+// timer 0 runs millis() and overflows about every ms. its compare A
+// interrupt, halfway between overflows, is free to use
+ISR(TIMER0_COMPA_vect) {
+  if(++timer_ticks < timer_period) { return; }
+  timer_ticks = 0;
+  timer_fn();
+}
+
+void hal_timer( void (*fn)(), uint8_t period ) {
+  TIMSK0 &= ~_BV(OCIE0A);
+  timer_fn = fn;
+  timer_period = period;
+  timer_ticks = 0;
+  OCR0A = 0x80;
+  TIMSK0 |= _BV(OCIE0A);
+}
+
+void hal_serial_print( const char *str ) { Serial.print(str); }
+void hal_serial_char( char ch ) { Serial.print(ch); }
+void hal_serial_number( uint32_t n ) { Serial.print((unsigned long)n); }
+
+// card reader of the TFT breakout, on the same SPI bus
+static bool sd_ready = false;
+static File sd_file;
+
+bool hal_sd_open( const char *name ) {
+  if(!sd_ready) { sd_ready = SD.begin(SD_CS); }
+  if(!sd_ready) { return false; }
+
+  if(sd_file) { sd_file.close(); }
+  sd_file = SD.open(name, FILE_READ);
+  return sd_file;
+}
+
+bool hal_sd_read( uint32_t pos, uint8_t *buf, uint16_t n ) {
+  if( !sd_file || !sd_file.seek(pos) ) { return false; }
+  return sd_file.read(buf, n) == n;
+}
+
+bool hal_save_read( uint16_t pos, uint8_t *buf, uint16_t n ) {
+  if(pos + n > EEPROM.length()) { return false; }
+  for( uint16_t k=0; k<n; ++k ) { buf[k] = EEPROM.read(pos + k); }
+  return true;
+}
+
+// update() skips bytes that already hold the value, a write is 3.3ms
+void hal_save_write( uint16_t pos, const uint8_t *buf, uint16_t n ) {
+  if(pos + n > EEPROM.length()) { return; }
+  for( uint16_t k=0; k<n; ++k ) { EEPROM.update(pos + k, buf[k]); }
+}
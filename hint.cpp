@@ -0,0 +1,126 @@
+#include<string.h>
+
+#include "hint.h"
+
+// values that none of the squares seeing i hold
+static uint16_t fresh( const rate_grid *g, uint8_t i ) {
+  uint8_t units[3] = { board_row(i), (uint8_t)(9 + board_col(i)), (uint8_t)(18 + board_box(i)) };
+  uint16_t seen = 0;
+  for( int k=0; k<3; ++k ) {
+    for( int j=0; j<9; ++j ) {
+      uint8_t n = g->cell[board_unit(units[k], j)];
+      if(n) { seen |= 1 << (n - 1); }
+    }
+  }
+  return ~seen & 0x1FF;
+}
+
+static void refresh( rate_grid *g, uint8_t i ) {
+  g->cand[i] = g->cell[i] ? 0 : fresh(g, i);
+}
+
+static void drop_hint( hint_state *h ) {
+  h->busy = false;
+  h->why.square = HINT_NONE;
+  memset(h->why.cells, 0, sizeof(h->why.cells));
+}
+
+void hint_load( hint_state *h, const board *b ) {
+  rate_clear(&h->g);
+  for( uint8_t i=0; i<81; ++i ) {
+    uint8_t n = board_get(b, i);
+    if(n) { rate_place(&h->g, i, n); }
+  }
+  h->pruned = false;
+  drop_hint(h);
+}
+
+void hint_set( hint_state *h, uint8_t i, uint8_t n ) {
+  rate_grid *g = &h->g;
+  drop_hint(h);
+  if(g->cell[i] == n) { return; }
+
+  // the old value can go back on the squares that see i. a hint step
+  // may have ruled candidates out anywhere because of it
+  if(g->cell[i]) {
+    g->cell[i] = 0;
+    g->left++;
+    if(h->pruned) {
+      for( uint8_t j=0; j<81; ++j ) { refresh(g, j); }
+      h->pruned = false;
+    }
+    else {
+      uint8_t units[3] = { board_row(i), (uint8_t)(9 + board_col(i)), (uint8_t)(18 + board_box(i)) };
+      for( int k=0; k<3; ++k ) {
+        for( int j=0; j<9; ++j ) { refresh(g, board_unit(units[k], j)); }
+      }
+    }
+  }
+
+  // only the 20 squares that see i lose n
+  if(n) { rate_place(g, i, n); }
+}
+
+void hint_start( hint_state *h ) {
+  drop_hint(h);
+  h->busy = true;
+  h->technique = RATE_HIDDEN_SINGLE;
+  h->g.bad = false; // left by a wrong value, if any
+}
+
+// the soln's value on square i as the hint
+static bool give( hint_state *h, uint8_t i, int technique, const board *soln ) {
+  drop_hint(h);
+  h->technique = technique;
+  h->why.square = i;
+  h->why.value = board_get(soln, i);
+  return true;
+}
+
+bool hint_step( hint_state *h, const board *soln ) {
+  if(!h->busy) { return false; }
+  rate_grid *g = &h->g;
+
+  for( uint8_t i=0; i<81; ++i ) {
+    if(g->cell[i] && g->cell[i] != board_get(soln, i)) { return give(h, i, HINT_WRONG, soln); }
+  }
+  if(g->left == 0) {
+    drop_hint(h);
+    return false;
+  }
+
+  // a step that places a value only finds the hint: the player places it
+  uint16_t cand[81];
+  memcpy(cand, g->cand, sizeof(cand));
+
+  int t = rate_step(g, &h->why);
+  if(t == RATE_GUESS || g->bad) {
+    // no technique gets further: the soln's value on the square with the
+    // fewest candidates
+    memcpy(g->cand, cand, sizeof(cand));
+    g->bad = false;
+    uint8_t best = HINT_NONE;
+    for( uint8_t i=0; i<81; ++i ) {
+      if(g->cell[i]) { continue; }
+      if(best == HINT_NONE || __builtin_popcount(g->cand[i]) < __builtin_popcount(g->cand[best])) { best = i; }
+    }
+    return give(h, best, RATE_GUESS, soln);
+  }
+
+  if(t > h->technique) { h->technique = t; }
+  if(h->why.square == HINT_NONE) {
+    h->pruned = true;
+    return false;
+  }
+
+  g->cell[h->why.square] = 0;
+  g->left++;
+  memcpy(g->cand, cand, sizeof(cand));
+  h->busy = false;
+  return true;
+}
+
+const char *hint_name( int technique ) {
+  if(technique == HINT_WRONG) { return "wrong value"; }
+  return rate_name(technique);
+}
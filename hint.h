@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// hints
+//
+// finds the easiest next step on the player's board with the techniques
+// of rate.h, and the squares it follows from. the candidates of every
+// square are kept as the player goes: hint_set() takes a placed value off
+// the 20 squares that see it, so a hint never starts with a solve of the
+// board. a step that only rules candidates out (locked candidates, pairs
+// ...) is kept in them, and the next hint_step() goes on from there, one
+// technique a call, until a value can be placed. a call is one rate_step()
+// on 81 squares, so it fits in a frame on the Mega.
+//
+// a value that is not the soln's is hinted first: nothing that follows
+// from it can be trusted.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef HINT_H
+#define HINT_H
+
+#include<stdint.h>
+
+#include "board.h"
+#include "rate.h"
+
+#define HINT_NONE  81              // no square
+#define HINT_WRONG RATE_TECHNIQUES // technique: a value is not the soln's
+
+struct hint_state {
+  rate_grid g;       // the player's board and what each square can still take
+  bool pruned;       // g has candidates ruled out by hint steps
+  bool busy;         // hint_start() was called, no hint yet
+  uint8_t technique; // hardest technique on the way, RATE_HIDDEN_SINGLE etc.
+  rate_why why;      // the hint: value on square, HINT_NONE while there is none,
+                     // and the squares of every step on the way
+};
+
+// candidates of the values on b, no hint
+void hint_load( hint_state *h, const board *b );
+
+// square i of the player's board now holds n (0 == empty)
+// drops the hint shown
+void hint_set( hint_state *h, uint8_t i, uint8_t n );
+
+// starts looking for a hint
+void hint_start( hint_state *h );
+
+// one step towards the hint, soln is the soln of the puzzle
+// true --> h->why holds the hint. false --> not yet, while h->busy
+bool hint_step( hint_state *h, const board *soln );
+
+inline bool hint_shown( const hint_state *h ) {
+  return h->why.square != HINT_NONE;
+}
+
+// "hidden single" etc., or "wrong value"
+const char *hint_name( int technique );
+
+#endif
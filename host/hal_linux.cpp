@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////
+// hal.h for a Linux workstation
+//
+// the screen is a 128x160 framebuffer in memory and the joystick replays
+// a script, so the game runs headless under perf, gdb or the sanitizers.
+// time is virtual: hal_delay() returns at once and moves hal_millis()
+// forward, running the hal_timer() function on the way, so a script
+// replays the same way on every run.
+// hal_micros() is the real clock, for timing code.
+//
+// environment:
+//   SUDOKU_INPUT --> joystick script, one "<millis> <state>" per line.
+//                    state is centre, up, down, left, right or press and
+//                    holds until the next line. "end" stops the game.
+//                    lines starting with '#' are ignored
+//   SUDOKU_RUN_MS --> stop after this many virtual millis if there is
+//                     no script (default 60000)
+//   SUDOKU_SEED  --> seed for hal_noise() (default 1)
+//   SUDOKU_FB    --> write the last frame to this file as a PPM on exit
+//   SUDOKU_BANK  --> puzzle bank for hal_sd_open() (default: the name
+//                    asked for, in the current directory)
+//   SUDOKU_SAVE  --> file that stands in for the EEPROM (default: none,
+//                    nothing is saved)
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#include "hal.h"
+#include "font5x7.h"
+#include "probe.h"
+
+static uint16_t fb[TFT_HEIGHT][TFT_WIDTH];
+
+// joystick states a script can hold
+#define JOY_CENTRE 0
+#define JOY_UP     1
+#define JOY_DOWN   2
+#define JOY_LEFT   3
+#define JOY_RIGHT  4
+#define JOY_PRESS  5
+
+#define SCRIPT_MAX 4096
+
+struct script_step {
+  unsigned long at; // virtual millis the state starts
+  uint8_t state;
+};
+
+static script_step script[SCRIPT_MAX];
+static int script_len = 0;
+static unsigned long end_ms = 60000; // virtual millis the run stops
+
+static unsigned long now_ms = 0; // virtual clock
+static void (*timer_fn)() = NULL; // of hal_timer()
+static unsigned long timer_period = 1;
+static unsigned long timer_last = 0; // virtual millis of the last call
+static uint32_t noise = 1;       // xorshift state for hal_noise()
+
+static const char *fb_path = NULL;
+
+static const uint8_t *sd_data = NULL; // file of hal_sd_open(), mapped
+static size_t sd_size = 0;
+
+// window for hal_push_pixels() and the next pixel in it
+static int win_x, win_y, win_w, win_h, win_pos;
+
+// writes the framebuffer as a binary PPM
+static void write_fb( const char *path ) {
+  FILE *f = fopen(path, "wb");
+  if(!f) {
+    perror(path);
+    return;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", TFT_WIDTH, TFT_HEIGHT);
+  for( int y=0; y<TFT_HEIGHT; ++y ) {
+    for( int x=0; x<TFT_WIDTH; ++x ) {
+      uint16_t c = fb[y][x];
+      uint8_t rgb[3] = { (uint8_t)((c >> 8) & 0xF8), (uint8_t)((c >> 3) & 0xFC), (uint8_t)(c << 3) };
+      fwrite(rgb, 1, 3, f);
+    }
+  }
+  fclose(f);
+}
+
+// ends the run once the script is over
+static void finish() {
+  if(fb_path) { write_fb(fb_path); }
+  fflush(stdout);
+  probe_print(); // JSON on stderr, with PROBE
+  exit(0);
+}
+
+static bool parse_state( const char *word, uint8_t *state ) {
+  static const char *names[] = { "centre", "up", "down", "left", "right", "press" };
+  for( int i=0; i<6; ++i ) {
+    if( strcmp(word, names[i]) == 0 ) {
+      *state = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void load_script( const char *path ) {
+  FILE *f = fopen(path, "r");
+  if(!f) {
+    perror(path);
+    exit(2);
+  }
+
+  char line[128];
+  int lineno = 0;
+  while( fgets(line, sizeof(line), f) ) {
+    lineno++;
+    unsigned long at;
+    char word[32];
+    if(line[0] == '#' || sscanf(line, "%lu %31s", &at, word) != 2) { continue; }
+
+    if( strcmp(word, "end") == 0 ) {
+      end_ms = at;
+      break;
+    }
+    if(script_len == SCRIPT_MAX || !parse_state(word, &script[script_len].state)) {
+      fprintf(stderr, "%s:%d: bad step \"%s\"\n", path, lineno, word);
+      exit(2);
+    }
+    script[script_len].at = at;
+    script_len++;
+  }
+  fclose(f);
+}
+
+// joystick state at the current virtual time
+static uint8_t joy_state() {
+  uint8_t state = JOY_CENTRE;
+  for( int i=0; i<script_len && script[i].at <= now_ms; ++i ) { state = script[i].state; }
+  return state;
+}
+
+void hal_init() {
+  const char *seed = getenv("SUDOKU_SEED");
+  if(seed) { noise = strtoul(seed, NULL, 0); }
+  if(noise == 0) { noise = 1; }
+
+  const char *run_ms = getenv("SUDOKU_RUN_MS");
+  if(run_ms) { end_ms = strtoul(run_ms, NULL, 0); }
+
+  const char *input = getenv("SUDOKU_INPUT");
+  if(input) { load_script(input); }
+
+  fb_path = getenv("SUDOKU_FB");
+  memset(fb, 0, sizeof(fb));
+}
+
+static void put_pixel( int x, int y, uint16_t color ) {
+  if(x < 0 || y < 0 || x >= TFT_WIDTH || y >= TFT_HEIGHT) { return; }
+  fb[y][x] = color;
+}
+
+void hal_fill_screen( uint16_t color ) { hal_fill_rect(0, 0, TFT_WIDTH, TFT_HEIGHT, color); }
+
+void hal_draw_rect( int x, int y, int w, int h, uint16_t color ) {
+  for( int i=0; i<w; ++i ) {
+    put_pixel(x + i, y, color);
+    put_pixel(x + i, y + h - 1, color);
+  }
+  for( int j=0; j<h; ++j ) {
+    put_pixel(x, y + j, color);
+    put_pixel(x + w - 1, y + j, color);
+  }
+}
+
+void hal_fill_rect( int x, int y, int w, int h, uint16_t color ) {
+  for( int j=0; j<h; ++j ) {
+    for( int i=0; i<w; ++i ) { put_pixel(x + i, y + j, color); }
+  }
+}
+
+// 6x8 cell per character like Adafruit_GFX: 5 font columns, 1 blank
+void hal_draw_char( int x, int y, char ch, uint16_t fg, uint16_t bg, uint8_t size ) {
+  const uint8_t *glyph = font5x7[0];
+  if(ch >= FONT_FIRST && ch <= FONT_LAST) { glyph = font5x7[ch - FONT_FIRST]; }
+
+  for( int i=0; i<6; ++i ) {
+    uint8_t line = (i < 5) ? glyph[i] : 0;
+    for( int j=0; j<8; ++j, line >>= 1 ) {
+      uint16_t color = (line & 1) ? fg : bg;
+      if( !(line & 1) && bg == fg ) { continue; } // transparent background
+      hal_fill_rect(x + i*size, y + j*size, size, size, color);
+    }
+  }
+}
+
+void hal_text( int x, int y, uint8_t size, uint16_t fg, uint16_t bg, const char *str ) {
+  for( ; *str; ++str, x += 6*size ) { hal_draw_char(x, y, *str, fg, bg, size); }
+}
+
+void hal_window( int x, int y, int w, int h ) {
+  win_x = x;
+  win_y = y;
+  win_w = w;
+  win_h = h;
+  win_pos = 0;
+}
+
+void hal_push_pixels( const uint16_t *pixels, int n ) {
+  for( int i=0; i<n; ++i ) {
+    if(win_w <= 0 || win_pos >= win_w * win_h) { win_pos = 0; } // wraps like the panel
+    put_pixel(win_x + win_pos % win_w, win_y + win_pos / win_w, pixels[i]);
+    win_pos++;
+  }
+}
+
+int hal_joy_read( int axis ) {
+  uint8_t state = joy_state();
+  if(axis == JOY_VERT) {
+    if(state == JOY_UP)   { return 0; }
+    if(state == JOY_DOWN) { return 1023; }
+  }
+  else {
+    if(state == JOY_LEFT)  { return 0; }
+    if(state == JOY_RIGHT) { return 1023; }
+  }
+  return 512;
+}
+
+bool hal_joy_pressed() { return joy_state() == JOY_PRESS; }
+
+int hal_noise() {
+  noise ^= noise << 13;
+  noise ^= noise >> 17;
+  noise ^= noise << 5;
+  return noise & 1;
+}
+
+unsigned long hal_millis() { return now_ms; }
+
+unsigned long hal_micros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+// the timer of hal_timer() runs on the virtual clock too
+void hal_delay( unsigned long ms ) {
+  for( ; ms; --ms ) {
+    now_ms++;
+    if(timer_fn && now_ms - timer_last >= timer_period) {
+      timer_last = now_ms;
+      timer_fn();
+    }
+    if(now_ms >= end_ms) { finish(); }
+  }
+}
+
+void hal_timer( void (*fn)(), uint8_t period ) {
+  timer_fn = fn;
+  timer_period = period;
+  timer_last = now_ms;
+}
+
+void hal_serial_print( const char *str ) { fputs(str, stdout); }
+void hal_serial_char( char ch ) { putchar(ch); }
+void hal_serial_number( uint32_t n ) { printf("%lu", (unsigned long)n); }
+
+// the file is mapped whole, like the bank tools do
+bool hal_sd_open( const char *name ) {
+  const char *path = getenv("SUDOKU_BANK");
+  if(!path) { path = name; }
+
+  if(sd_data) { munmap((void *)sd_data, sd_size); }
+  sd_data = NULL;
+  sd_size = 0;
+
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) { return false; }
+  struct stat st;
+  if( fstat(fd, &st) != 0 || st.st_size == 0 ) { close(fd); return false; }
+  void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(p == MAP_FAILED) { return false; }
+
+  sd_data = (const uint8_t *)p;
+  sd_size = st.st_size;
+  return true;
+}
+
+bool hal_sd_read( uint32_t pos, uint8_t *buf, uint16_t n ) {
+  if(!sd_data || pos > sd_size || n > sd_size - pos) { return false; }
+  memcpy(buf, sd_data + pos, n);
+  return true;
+}
+
+#define SAVE_BYTES 4096 // as the Mega's EEPROM
+
+// a missing file reads as an erased EEPROM, all 0xFF
+bool hal_save_read( uint16_t pos, uint8_t *buf, uint16_t n ) {
+  const char *path = getenv("SUDOKU_SAVE");
+  if(!path || pos + n > SAVE_BYTES) { return false; }
+  memset(buf, 0xFF, n);
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) { return true; }
+  ssize_t got = pread(fd, buf, n, pos);
+  close(fd);
+  return got >= 0;
+}
+
+void hal_save_write( uint16_t pos, const uint8_t *buf, uint16_t n ) {
+  const char *path = getenv("SUDOKU_SAVE");
+  if(!path || pos + n > SAVE_BYTES) { return; }
+  int fd = open(path, O_WRONLY | O_CREAT, 0644);
+  if(fd < 0) { return; }
+  if( pwrite(fd, buf, n, pos) != n ) { perror(path); }
+  close(fd);
+}
@@ -0,0 +1,68 @@
+# native build for a Linux workstation, included by the top Makefile for
+# `make host`. everything lands in build-host/
+#
+#   make host                          --> optimized with debug info
+#   make host HOST_CXXFLAGS="-O1 -g -fsanitize=address,undefined"
+#   make host-bench [BASELINE=old.txt]  --> runs bench/suite.cpp
+#   make host-clean
+
+HOST_CXX ?= g++
+HOST_CXXFLAGS ?= -O2 -g
+HOST_CPPFLAGS = -I. -Ihost -Wall
+HOST_LDFLAGS ?=
+HOST_BUILD = build-host
+
+# solver and generator code shared with the Arduino build
+ENGINE_SRCS = solver.cpp dlx.cpp generator.cpp rng.cpp board.cpp bank.cpp rate.cpp probe.cpp
+# the game itself, with the Linux HAL instead of hal_arduino.cpp
+GAME_SRCS = sudoku.cpp scheduler.cpp pregen.cpp render.cpp glyph.cpp check.cpp journal.cpp save.cpp hint.cpp notes.cpp input.cpp host/hal_linux.cpp $(ENGINE_SRCS)
+BENCH_SRCS = bench/solver_bench.cpp $(ENGINE_SRCS)
+GEN_SRCS = host/sudoku_gen.cpp $(ENGINE_SRCS)
+SOLVE_SRCS = host/sudoku_solve.cpp $(ENGINE_SRCS)
+SIMD_BENCH_SRCS = bench/simd_bench.cpp host/solver_simd.cpp $(ENGINE_SRCS)
+BANK_SRCS = host/sudoku_bank.cpp $(ENGINE_SRCS)
+SUITE_SRCS = bench/suite.cpp bench/mock_hal.cpp render.cpp glyph.cpp hint.cpp $(ENGINE_SRCS)
+
+HOST_BINS = $(HOST_BUILD)/sudoku $(HOST_BUILD)/solver_bench $(HOST_BUILD)/sudoku-gen \
+            $(HOST_BUILD)/sudoku-solve $(HOST_BUILD)/simd_bench $(HOST_BUILD)/sudoku-bank \
+            $(HOST_BUILD)/bench_suite
+
+objs = $(patsubst %.cpp,$(HOST_BUILD)/%.o,$(1))
+
+.PHONY: host host-clean host-bench
+
+host: $(HOST_BINS)
+
+$(HOST_BUILD)/sudoku: $(call objs,$(GAME_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) $^ -o $@ $(HOST_LDFLAGS)
+
+$(HOST_BUILD)/solver_bench: $(call objs,$(BENCH_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) $^ -o $@ $(HOST_LDFLAGS)
+
+$(HOST_BUILD)/sudoku-gen: $(call objs,$(GEN_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) -pthread $^ -o $@ $(HOST_LDFLAGS)
+
+$(HOST_BUILD)/sudoku-solve: $(call objs,$(SOLVE_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) $^ -o $@ $(HOST_LDFLAGS)
+
+$(HOST_BUILD)/simd_bench: $(call objs,$(SIMD_BENCH_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) $^ -o $@ $(HOST_LDFLAGS)
+
+$(HOST_BUILD)/sudoku-bank: $(call objs,$(BANK_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) $^ -o $@ $(HOST_LDFLAGS)
+
+$(HOST_BUILD)/bench_suite: $(call objs,$(SUITE_SRCS))
+	$(HOST_CXX) $(HOST_CXXFLAGS) $^ -o $@ $(HOST_LDFLAGS)
+
+# make host-bench BASELINE=old.txt compares with a saved run
+host-bench: $(HOST_BUILD)/bench_suite
+	$(HOST_BUILD)/bench_suite $(if $(BASELINE),--baseline $(BASELINE))
+
+$(HOST_BUILD)/%.o: %.cpp
+	@mkdir -p $(dir $@)
+	$(HOST_CXX) $(HOST_CXXFLAGS) $(HOST_CPPFLAGS) -MMD -MP -c $< -o $@
+
+host-clean:
+	rm -rf $(HOST_BUILD)
+
+-include $(wildcard $(HOST_BUILD)/*.d $(HOST_BUILD)/*/*.d)
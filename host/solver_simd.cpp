@@ -0,0 +1,189 @@
+#include<string.h>
+
+#include "solver.h"
+#include "solver_simd.h"
+
+// SIMD_LANES masks of 16 bits, one AVX2 register. gcc maps operators on
+// this type to AVX2 instructions inside avx2 functions
+typedef uint16_t lanes __attribute__((vector_size(SIMD_LANES * 2)));
+// half of it, one SSE2 register
+typedef uint16_t half_lanes __attribute__((vector_size(SIMD_LANES)));
+
+// square indices of the 27 units: rows, then cols, then boxes
+static const uint8_t unit_cells[27][9] = {
+  {  0, 1, 2, 3, 4, 5, 6, 7, 8 }, {  9,10,11,12,13,14,15,16,17 },
+  { 18,19,20,21,22,23,24,25,26 }, { 27,28,29,30,31,32,33,34,35 },
+  { 36,37,38,39,40,41,42,43,44 }, { 45,46,47,48,49,50,51,52,53 },
+  { 54,55,56,57,58,59,60,61,62 }, { 63,64,65,66,67,68,69,70,71 },
+  { 72,73,74,75,76,77,78,79,80 },
+  {  0, 9,18,27,36,45,54,63,72 }, {  1,10,19,28,37,46,55,64,73 },
+  {  2,11,20,29,38,47,56,65,74 }, {  3,12,21,30,39,48,57,66,75 },
+  {  4,13,22,31,40,49,58,67,76 }, {  5,14,23,32,41,50,59,68,77 },
+  {  6,15,24,33,42,51,60,69,78 }, {  7,16,25,34,43,52,61,70,79 },
+  {  8,17,26,35,44,53,62,71,80 },
+  {  0, 1, 2, 9,10,11,18,19,20 }, {  3, 4, 5,12,13,14,21,22,23 },
+  {  6, 7, 8,15,16,17,24,25,26 }, { 27,28,29,36,37,38,45,46,47 },
+  { 30,31,32,39,40,41,48,49,50 }, { 33,34,35,42,43,44,51,52,53 },
+  { 54,55,56,63,64,65,72,73,74 }, { 57,58,59,66,67,68,75,76,77 },
+  { 60,61,62,69,70,71,78,79,80 }
+};
+
+// 0xFFFF in the lanes where the mask has at most one bit
+#define AT_MOST_ONE(c) ((V)(((c) & ((c) - 1)) == 0))
+// 0xFFFF in the lanes where the mask is not 0
+#define NOT_ZERO(c) ((V)((c) != 0))
+
+// naked and hidden singles on every lane until nothing changes
+// square i is cand[i*stride], so half of a lanes array can be worked on
+// lanes of *bad are set for puzzles found to have no soln
+// returns the number of passes
+template<typename V>
+static inline __attribute__((always_inline))
+int propagate_lanes( V *cand, int stride, V *bad ) {
+  const V all = (V){} + SOLVER_ALL;
+  int rounds = 0;
+
+  while(true) {
+    V changed = {};
+    rounds++;
+
+    for( int u=0; u<27; ++u ) {
+      const uint8_t *cells = unit_cells[u];
+
+      // values seen once / more than once, over candidates and solved squares
+      V once = {}, twice = {}, solved = {}, clash = {};
+      for( int k=0; k<9; ++k ) {
+        V c = cand[cells[k]*stride];
+        V single = c & AT_MOST_ONE(c);
+        twice |= once & c;
+        once |= c;
+        clash |= solved & single;
+        solved |= single;
+      }
+
+      // a value solved twice or with nowhere to go --> no soln
+      *bad |= NOT_ZERO(clash) | NOT_ZERO(once ^ all);
+      V hidden = once & ~twice;
+
+      for( int k=0; k<9; ++k ) {
+        V c = cand[cells[k]*stride];
+        V single = AT_MOST_ONE(c);
+        // drop values solved on other squares of the unit
+        V nc = c & ~(solved & ~(c & single));
+        // a value that fits only here is this square's value
+        V h = nc & hidden;
+        V take = NOT_ZERO(h) & ~single;
+        nc = (h & take) | (nc & ~take);
+
+        *bad |= ~NOT_ZERO(nc);
+        changed |= nc ^ c;
+        cand[cells[k]*stride] = nc;
+      }
+    }
+
+    // candidates only shrink, so this ends
+    V none = {};
+    if( memcmp(&changed, &none, sizeof(V)) == 0 ) { return rounds; }
+  }
+}
+
+__attribute__((target("avx2")))
+static int propagate_avx2( lanes *cand, lanes *bad ) { return propagate_lanes(cand, 1, bad); }
+
+// two halves of 8 puzzles, one after the other
+static int propagate_sse2( lanes *cand, lanes *bad ) {
+  half_lanes *half = (half_lanes *)cand;
+  half_lanes *half_bad = (half_lanes *)bad;
+  int lo = propagate_lanes(half, 2, &half_bad[0]);
+  int hi = propagate_lanes(half + 1, 2, &half_bad[1]);
+  return lo > hi ? lo : hi;
+}
+
+int simd_best() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports("avx2") ) { return SIMD_AVX2; }
+  return SIMD_SSE2;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+const char *simd_name( int isa ) {
+  if(isa == SIMD_AVX2) { return "avx2"; }
+  if(isa == SIMD_SSE2) { return "sse2"; }
+  return "scalar";
+}
+
+// scalar search on one puzzle
+static bool solve_one( const uint8_t *cells, uint8_t *soln ) {
+  solver_state s;
+  if( !solver_load(&s, cells) || !solver_solve(&s, SOLVER_MRV) ) { return false; }
+  memcpy(soln, s.cell, 81);
+  return true;
+}
+
+int simd_solve( int isa, const uint8_t *cells, int n, uint8_t *solns, bool *ok,
+                simd_stats *stats ) {
+  simd_stats st = {};
+  int solved = 0;
+
+  if(isa == SIMD_SCALAR) {
+    for( int p=0; p<n; ++p ) {
+      ok[p] = solve_one(cells + p*81, solns + p*81);
+      solved += ok[p];
+      st.fallback++;
+    }
+    st.puzzles = n;
+  }
+
+  for( int first=0; isa != SIMD_SCALAR && first<n; first += SIMD_LANES ) {
+    int count = n - first;
+    if(count > SIMD_LANES) { count = SIMD_LANES; }
+
+    // load candidates, lane by lane. unused lanes get an empty puzzle
+    lanes cand[81];
+    for( int i=0; i<81; ++i ) {
+      for( int l=0; l<SIMD_LANES; ++l ) {
+        uint8_t v = (l < count) ? cells[(first + l)*81 + i] : 0;
+        cand[i][l] = v ? solver_bit(v) : SOLVER_ALL;
+      }
+    }
+
+    lanes bad = {};
+    st.rounds += (isa == SIMD_AVX2) ? propagate_avx2(cand, &bad)
+                                    : propagate_sse2(cand, &bad);
+
+    for( int l=0; l<count; ++l ) {
+      int p = first + l;
+      uint8_t *soln = solns + p*81;
+
+      bool open = false;
+      for( int i=0; i<81; ++i ) {
+        uint16_t c = cand[i][l];
+        if(solver_count(c) == 1) { soln[i] = solver_value(c); }
+        else { soln[i] = 0; open = true; }
+      }
+
+      if(bad[l]) { ok[p] = false; st.propagated++; }
+      else if(!open) { ok[p] = true; st.propagated++; }
+      else {
+        // lanes diverge here: search from the propagated squares
+        uint8_t start[81];
+        memcpy(start, soln, 81);
+        ok[p] = solve_one(start, soln);
+        st.fallback++;
+      }
+      solved += ok[p];
+    }
+    st.puzzles += count;
+  }
+
+  if(stats) {
+    stats->puzzles += st.puzzles;
+    stats->rounds += st.rounds;
+    stats->propagated += st.propagated;
+    stats->fallback += st.fallback;
+  }
+  return solved;
+}
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////
+// multi-puzzle solver for the host
+//
+// solves SIMD_LANES puzzles in lockstep. each square keeps a 9-bit
+// candidate mask per puzzle, one 16-bit lane each, so every mask operation
+// works on all the puzzles at once (one AVX2 register, or two SSE2 ones).
+// naked and hidden singles are propagated for the whole batch until
+// nothing changes. puzzles that still have open squares then finish one
+// at a time with the scalar MRV search of solver.h.
+//
+// simd_best() picks the widest instruction set the CPU has at runtime.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SOLVER_SIMD_H
+#define SOLVER_SIMD_H
+
+#include<stdint.h>
+
+#define SIMD_LANES 16 // puzzles per batch
+
+// instruction sets for simd_solve()
+#define SIMD_SCALAR 0 // solver_solve() on each puzzle, no batching
+#define SIMD_SSE2   1
+#define SIMD_AVX2   2
+
+// counters, added to by simd_solve()
+struct simd_stats {
+  uint32_t puzzles;
+  uint32_t rounds;     // propagation passes over all 27 units
+  uint32_t propagated; // puzzles finished or refuted by propagation alone
+  uint32_t fallback;   // puzzles finished by the scalar search
+};
+
+// best instruction set this CPU supports
+int simd_best();
+
+// "scalar", "sse2" or "avx2"
+const char *simd_name( int isa );
+
+// solves n puzzles of 81 values (0 == empty), any n
+// solns gets 81 values per puzzle, ok[i] is false if puzzle i has no soln
+// stats may be NULL. returns the number of puzzles solved
+int simd_solve( int isa, const uint8_t *cells, int n, uint8_t *solns, bool *ok,
+                simd_stats *stats );
+
+#endif
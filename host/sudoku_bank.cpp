@@ -0,0 +1,271 @@
+///////////////////////////////////////////////////////////////////////////////
+// puzzle bank tool for the host
+//
+// build: make host  (build-host/sudoku-bank)
+// run:   build-host/sudoku-bank build BANK easy.txt medium.txt hard.txt
+//        build-host/sudoku-bank info BANK
+//        build-host/sudoku-bank dump BANK [level [grade]]
+//        build-host/sudoku-bank pick BANK level count [seed]
+//
+// build packs the puzzles of three files from the batch generator, e.g.
+//   build-host/sudoku-gen --count 1000 --difficulty easy > easy.txt
+// into the bank format of bank.h. a puzzle that is malformed or not unique
+// is left out. copy the bank onto the SD card as SUDOKU.BIN.
+//
+// the input files and the bank are mmap'd, so info, dump and pick only
+// touch the pages they need: dump writes every puzzle of a level (and
+// grade) and pick writes count random ones, as the game would take them.
+// puzzles are written in the bench/corpus/ format.
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<vector>
+
+#include "bank.h"
+#include "solver.h"
+
+static const char *level_names[BANK_LEVELS] = { "easy", "medium", "hard" };
+
+struct mapped {
+  const uint8_t *data;
+  size_t size;
+};
+
+// maps a whole file read-only, false if it cannot
+static bool map_file( const char *path, mapped *m ) {
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) { return false; }
+  struct stat st;
+  if( fstat(fd, &st) != 0 ) { close(fd); return false; }
+
+  m->size = st.st_size;
+  m->data = (const uint8_t *)"";
+  if(m->size) {
+    void *p = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(p == MAP_FAILED) { close(fd); return false; }
+    m->data = (const uint8_t *)p;
+  }
+  close(fd);
+  return true;
+}
+
+static void unmap_file( mapped *m ) {
+  if(m->size) { munmap((void *)m->data, m->size); }
+}
+
+// 81 squares from [p, end), false if the line is not a puzzle
+static bool parse_puzzle( const uint8_t *p, const uint8_t *end, uint8_t *cells ) {
+  if(end - p != 81) { return false; }
+  for( int i=0; i<81; ++i ) {
+    uint8_t c = p[i];
+    if(c >= '1' && c <= '9') { cells[i] = c - '0'; }
+    else if(c == '.' || c == '0') { cells[i] = 0; }
+    else { return false; }
+  }
+  return true;
+}
+
+// level by name or number, -1 if neither
+static int parse_level( const char *s ) {
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    if( strcmp(s, level_names[l]) == 0 ) { return l; }
+  }
+  char *end;
+  long l = strtol(s, &end, 10);
+  if(*end || l < 0 || l >= BANK_LEVELS) { return -1; }
+  return (int)l;
+}
+
+// writes the givens of a record as one corpus line
+static void print_record( const uint8_t *bytes ) {
+  board soln;
+  bank_read_record(bytes, &soln);
+
+  char line[82];
+  for( uint8_t i=0; i<81; ++i ) {
+    line[i] = board_is_fixed(&soln, i) ? '0' + board_get(&soln, i) : '.';
+  }
+  line[81] = '\n';
+  fwrite(line, 1, 82, stdout);
+}
+
+static int build( const char *path, char **inputs ) {
+  // records of each level and grade, in file order
+  std::vector<uint8_t> records[BANK_LEVELS][BANK_GRADES];
+  int skipped = 0;
+
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    mapped in;
+    if( !map_file(inputs[l], &in) ) {
+      fprintf(stderr, "cannot read %s\n", inputs[l]);
+      return 1;
+    }
+
+    const uint8_t *p = in.data;
+    const uint8_t *end = in.data + in.size;
+    while(p < end) {
+      const uint8_t *eol = (const uint8_t *)memchr(p, '\n', end - p);
+      if(!eol) { eol = end; }
+      const uint8_t *next = eol + 1;
+      if(eol > p && eol[-1] == '\r') { --eol; }
+      if(eol == p || *p == '#') { p = next; continue; }
+
+      uint8_t cells[81];
+      solver_state s;
+      if( !parse_puzzle(p, eol, cells) || count_solutions(cells, 2) != 1 ||
+          !solver_load(&s, cells) || !solver_solve(&s, SOLVER_MRV) ) {
+        skipped++;
+        p = next;
+        continue;
+      }
+      p = next;
+
+      // soln with the givens fixed
+      board soln;
+      board_load(&soln, s.cell);
+      for( uint8_t i=0; i<81; ++i ) { board_set_fixed(&soln, i, cells[i] != 0); }
+
+      std::vector<uint8_t> &out = records[l][bank_grade(cells)];
+      out.resize(out.size() + BANK_RECORD);
+      bank_write_record(&soln, &out[out.size() - BANK_RECORD]);
+    }
+    unmap_file(&in);
+  }
+
+  bank_header h;
+  uint32_t first = 0;
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    for( int g=0; g<BANK_GRADES; ++g ) {
+      h.index[l][g].first = first;
+      h.index[l][g].count = records[l][g].size() / BANK_RECORD;
+      first += h.index[l][g].count;
+    }
+  }
+
+  FILE *f = fopen(path, "wb");
+  if(!f) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return 1;
+  }
+  uint8_t header[BANK_HEADER];
+  bank_write_header(&h, header);
+  bool ok = fwrite(header, 1, BANK_HEADER, f) == BANK_HEADER;
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    for( int g=0; g<BANK_GRADES; ++g ) {
+      std::vector<uint8_t> &r = records[l][g];
+      if( !r.empty() ) { ok = ok && fwrite(&r[0], 1, r.size(), f) == r.size(); }
+    }
+  }
+  if(fclose(f) != 0) { ok = false; }
+  if(!ok) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return 1;
+  }
+
+  fprintf(stderr, "%u puzzles, %d skipped, %lu bytes\n", first, skipped,
+          (unsigned long)bank_offset(first));
+  return 0;
+}
+
+// maps a bank and checks its header and size
+static bool open_bank( const char *path, mapped *m, bank_header *h ) {
+  if( !map_file(path, m) ) {
+    fprintf(stderr, "cannot read %s\n", path);
+    return false;
+  }
+  if( m->size < BANK_HEADER || !bank_read_header(m->data, h) ) {
+    fprintf(stderr, "%s is not a puzzle bank\n", path);
+    return false;
+  }
+  for( int l=0; l<BANK_LEVELS; ++l ) {
+    for( int g=0; g<BANK_GRADES; ++g ) {
+      const bank_index *ix = &h->index[l][g];
+      if( bank_offset(ix->first + ix->count) > m->size ) {
+        fprintf(stderr, "%s is truncated\n", path);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void usage() {
+  fprintf(stderr, "usage: sudoku-bank build BANK easy.txt medium.txt hard.txt\n"
+                  "       sudoku-bank info BANK\n"
+                  "       sudoku-bank dump BANK [level [grade]]\n"
+                  "       sudoku-bank pick BANK level count [seed]\n");
+}
+
+int main( int argc, char **argv ) {
+  if(argc < 3) { usage(); return 2; }
+  const char *cmd = argv[1];
+
+  if( strcmp(cmd, "build") == 0 ) {
+    if(argc != 3 + BANK_LEVELS) { usage(); return 2; }
+    return build(argv[2], argv + 3);
+  }
+
+  mapped m;
+  bank_header h;
+  if( !open_bank(argv[2], &m, &h) ) { return 1; }
+
+  if( strcmp(cmd, "info") == 0 && argc == 3 ) {
+    printf("%-8s", "level");
+    for( int g=0; g<BANK_GRADES; ++g ) { printf(" %7s%d", "grade ", g); }
+    printf(" %8s\n", "all");
+    for( int l=0; l<BANK_LEVELS; ++l ) {
+      printf("%-8s", level_names[l]);
+      for( int g=0; g<BANK_GRADES; ++g ) { printf(" %8u", h.index[l][g].count); }
+      printf(" %8u\n", bank_count(&h, l));
+    }
+    return 0;
+  }
+
+  if( strcmp(cmd, "dump") == 0 && argc <= 5 ) {
+    int level = (argc > 3) ? parse_level(argv[3]) : -1;
+    int grade = (argc > 4) ? atoi(argv[4]) : -1;
+    if( (argc > 3 && level < 0) || (argc > 4 && (grade < 0 || grade >= BANK_GRADES)) ) {
+      usage();
+      return 2;
+    }
+
+    for( int l=0; l<BANK_LEVELS; ++l ) {
+      if(level >= 0 && l != level) { continue; }
+      for( int g=0; g<BANK_GRADES; ++g ) {
+        if(grade >= 0 && g != grade) { continue; }
+        const bank_index *ix = &h.index[l][g];
+        for( uint32_t k=0; k<ix->count; ++k ) { print_record(m.data + bank_offset(ix->first + k)); }
+      }
+    }
+    return 0;
+  }
+
+  if( strcmp(cmd, "pick") == 0 && (argc == 5 || argc == 6) ) {
+    int level = parse_level(argv[3]);
+    if(level < 0) { usage(); return 2; }
+    long count = atol(argv[4]);
+
+    // same pick as the game
+    rng_state r;
+    rng_seed(&r, (argc == 6) ? strtoul(argv[5], NULL, 0) : 1);
+    for( long i=0; i<count; ++i ) {
+      uint32_t record;
+      if( !bank_pick(&h, level, &r, &record) ) {
+        fprintf(stderr, "no %s puzzles in %s\n", level_names[level], argv[2]);
+        return 1;
+      }
+      print_record(m.data + bank_offset(record));
+    }
+    return 0;
+  }
+
+  usage();
+  return 2;
+}
@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////////////
+// batch puzzle generator for the host
+//
+// build: make host  (build-host/sudoku-gen)
+// run:   build-host/sudoku-gen [--count N] [--difficulty easy|medium|hard]
+//                              [--clues] [--minimal] [--threads T] [--seed S] [--scale]
+//
+// writes one puzzle per line to stdout, 81 chars, '.' == empty square,
+// the same format as bench/corpus/. throughput goes to stderr.
+//
+// difficulty is rated by the techniques a person needs (see rate.h):
+// every puzzle is made with the fewest givens (GEN_HARD) and rated inline,
+// and only those of the asked level are kept. --clues goes back to the
+// old meaning, the number of givens of generator.h, with no rating.
+// --minimal strikes out givens until none can go (GEN_MINIMAL).
+//
+// the puzzles are split into chunks of CHUNK puzzles. every worker owns a
+// deque of chunks and takes from its back; a worker that runs dry steals
+// from the front of another worker's deque. each chunk reseeds the
+// generator from --seed and the chunk number, so a given seed always makes
+// the same set of puzzles whatever the thread count, only the order of
+// the lines changes.
+//
+// --scale runs the batch with 1, 2, 4 ... T threads, discards the puzzles
+// and prints puzzles/s and speedup over one thread for each run.
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<time.h>
+#include<chrono>
+#include<deque>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+#include "generator.h"
+#include "rate.h"
+#include "probe.h"
+
+#define CHUNK 16 // puzzles per unit of work
+
+struct worker {
+  std::mutex lock;
+  std::deque<int> chunks;
+  int done;   // chunks generated
+  int stolen; // chunks taken from other workers
+  gen_stats gen; // of every puzzle generated, kept or not
+
+  worker() : done(0), stolen(0), gen() {}
+};
+
+struct batch {
+  int count;
+  int strikes;
+  int level;  // RATE_EASY etc., -1 --> keep every puzzle
+  uint32_t seed;
+  FILE *out; // NULL --> discard puzzles
+  std::mutex out_lock;
+  probe_stats probe; // of all the workers, under out_lock
+  std::vector<worker> workers;
+
+  batch( int nthreads ) : probe(), workers(nthreads) {}
+};
+
+// one seed per chunk. rng_seed() scrambles it, so neighbours are fine
+static uint32_t chunk_seed( uint32_t seed, int chunk ) {
+  return seed + 0x9E3779B9u * (uint32_t)chunk;
+}
+
+// own deque first, back end. then steal from the front of the others
+static bool next_chunk( batch *b, int id, int *chunk ) {
+  int n = (int)b->workers.size();
+
+  worker *w = &b->workers[id];
+  {
+    std::lock_guard<std::mutex> guard(w->lock);
+    if( !w->chunks.empty() ) {
+      *chunk = w->chunks.back();
+      w->chunks.pop_back();
+      return true;
+    }
+  }
+
+  for( int i=1; i<n; ++i ) {
+    worker *v = &b->workers[(id + i) % n];
+    std::lock_guard<std::mutex> guard(v->lock);
+    if( !v->chunks.empty() ) {
+      *chunk = v->chunks.front();
+      v->chunks.pop_front();
+      w->stolen++;
+      return true;
+    }
+  }
+  return false;
+}
+
+// true if the puzzle of g rates as level
+static bool rated_as( const gen_state *g, int level ) {
+  uint8_t cells[81];
+  board_givens(&g->puzzle, cells);
+  rate_result r;
+  return rate_puzzle(cells, &r) && rate_level(&r) == level;
+}
+
+static void add_stats( gen_stats *sum, const gen_stats *s ) {
+  sum->puzzles += s->puzzles;
+  sum->checks += s->checks;
+  if(s->max_checks > sum->max_checks) { sum->max_checks = s->max_checks; }
+  sum->pairs += s->pairs;
+  sum->skipped += s->skipped;
+}
+
+static void run_worker( batch *b, int id ) {
+  gen_state g;
+
+  char buf[CHUNK * 82];
+  int chunk;
+  while( next_chunk(b, id, &chunk) ) {
+    gen_init(&g, chunk_seed(b->seed, chunk));
+
+    int first = chunk * CHUNK;
+    int n = b->count - first;
+    if(n > CHUNK) { n = CHUNK; }
+
+    char *p = buf;
+    for( int k=0; k<n; ++k ) {
+      do {
+        gen_puzzle(&g, b->strikes);
+      } while( b->level >= 0 && !rated_as(&g, b->level) );
+      for( int i=0; i<81; ++i ) {
+        uint8_t v = board_get(&g.puzzle, i);
+        *p++ = v ? (char)('0' + v) : '.';
+      }
+      *p++ = '\n';
+    }
+
+    if(b->out) {
+      std::lock_guard<std::mutex> guard(b->out_lock);
+      fwrite(buf, 1, p - buf, b->out);
+    }
+    b->workers[id].done++;
+    add_stats(&b->workers[id].gen, &g.stats);
+  }
+
+  std::lock_guard<std::mutex> guard(b->out_lock);
+  probe_add(&b->probe);
+  probe_reset();
+}
+
+// generates count puzzles on nthreads threads, returns seconds taken
+// *stats gets the reducer counters of all the puzzles generated, so
+// stats->puzzles counts the ones not kept too
+static double run_batch( int count, int strikes, int level, uint32_t seed, int nthreads,
+                         FILE *out, bool verbose, gen_stats *stats ) {
+  batch b(nthreads);
+  b.count = count;
+  b.strikes = strikes;
+  b.level = level;
+  b.seed = seed;
+  b.out = out;
+
+  // deal the chunks round robin
+  int nchunks = (count + CHUNK - 1) / CHUNK;
+  for( int c=0; c<nchunks; ++c ) {
+    b.workers[c % nthreads].chunks.push_back(c);
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for( int i=0; i<nthreads; ++i ) {
+    threads.push_back(std::thread(run_worker, &b, i));
+  }
+  for( int i=0; i<nthreads; ++i ) { threads[i].join(); }
+  auto t1 = std::chrono::steady_clock::now();
+
+#ifdef PROBE
+  probe_print(&b.probe);
+#endif
+  *stats = gen_stats();
+  for( int i=0; i<nthreads; ++i ) { add_stats(stats, &b.workers[i].gen); }
+  if(verbose) {
+    for( int i=0; i<nthreads; ++i ) {
+      fprintf(stderr, "worker %d: %d chunks, %d stolen\n",
+              i, b.workers[i].done, b.workers[i].stolen);
+    }
+  }
+  return std::chrono::duration<double>(t1 - t0).count();
+}
+
+static void usage() {
+  fprintf(stderr, "usage: sudoku-gen [--count N] [--difficulty easy|medium|hard] [--clues]"
+                  " [--minimal] [--threads T] [--seed S] [--scale] [-v]\n");
+  exit(2);
+}
+
+int main( int argc, char **argv ) {
+  int count = 100;
+  int level = RATE_MEDIUM;
+  bool clues = false;
+  bool minimal = false;
+  int nthreads = (int)std::thread::hardware_concurrency();
+  uint32_t seed = (uint32_t)time(NULL);
+  bool scale = false;
+  bool verbose = false;
+
+  for( int i=1; i<argc; ++i ) {
+    const char *arg = argv[i];
+    const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if( strcmp(arg, "--scale") == 0 ) { scale = true; continue; }
+    if( strcmp(arg, "-v") == 0 ) { verbose = true; continue; }
+    if( strcmp(arg, "--clues") == 0 ) { clues = true; continue; }
+    if( strcmp(arg, "--minimal") == 0 ) { minimal = true; continue; }
+    if(val == NULL) { usage(); }
+
+    if( strcmp(arg, "--count") == 0 ) { count = atoi(val); }
+    else if( strcmp(arg, "--threads") == 0 ) { nthreads = atoi(val); }
+    else if( strcmp(arg, "--seed") == 0 ) { seed = (uint32_t)strtoul(val, NULL, 0); }
+    else if( strcmp(arg, "--difficulty") == 0 ) {
+      if     ( strcmp(val, "easy") == 0 )   { level = RATE_EASY; }
+      else if( strcmp(val, "medium") == 0 ) { level = RATE_MEDIUM; }
+      else if( strcmp(val, "hard") == 0 )   { level = RATE_HARD; }
+      else { usage(); }
+    }
+    else { usage(); }
+    ++i;
+  }
+  if(count < 0) { usage(); }
+  if(nthreads < 1) { nthreads = 1; }
+
+  // the level's number of givens, or the fewest and a rating
+  static const int level_strikes[3] = { GEN_EASY, GEN_MEDIUM, GEN_HARD };
+  int strikes = clues ? level_strikes[level] : GEN_HARD;
+  if(minimal) { strikes = GEN_MINIMAL; }
+  if(clues) { level = -1; }
+  gen_stats made;
+
+  if(!scale) {
+    double secs = run_batch(count, strikes, level, seed, nthreads, stdout, verbose, &made);
+    fflush(stdout);
+    fprintf(stderr, "%d puzzles in %.3f s, %.1f puzzles/s, %d threads, seed %u\n",
+            count, secs, count / secs, nthreads, seed);
+    if(level >= 0) {
+      fprintf(stderr, "%u generated and rated, %.1f%% kept\n", made.puzzles, 100.0 * count / made.puzzles);
+    }
+    if(made.puzzles) {
+      fprintf(stderr, "%.1f uniqueness checks per puzzle (max %u), %u pairs struck, %u known forced skipped\n",
+              (double)made.checks / made.puzzles, made.max_checks, made.pairs, made.skipped);
+    }
+    return 0;
+  }
+
+  fprintf(stderr, "threads  puzzles/s  speedup\n");
+  double base = 0;
+  for( int t=1; ; t *= 2 ) {
+    if(t > nthreads) { t = nthreads; }
+    double secs = run_batch(count, strikes, level, seed, t, NULL, verbose, &made);
+    double rate = count / secs;
+    if(t == 1) { base = rate; }
+    fprintf(stderr, "%7d  %9.1f  %6.2fx\n", t, rate, rate / base);
+    if(t == nthreads) { break; }
+  }
+  return 0;
+}
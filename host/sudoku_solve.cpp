@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+// batch solver for the host
+//
+// build: make host  (build-host/sudoku-solve)
+// run:   build-host/sudoku-solve [--unique] [file]
+//        build-host/sudoku-gen --count 10000 | build-host/sudoku-solve
+//
+// reads puzzles in the bench/corpus/ format: one per line, 81 chars,
+// '.' or '0' is an empty square, lines starting with '#' and blank lines
+// are ignored. a file is mmap'd, stdin is mmap'd too when it is a plain
+// file and read into one buffer otherwise. lines are parsed in place into
+// 81 byte grids, nothing is allocated per puzzle.
+//
+// writes one line per puzzle to stdout: the soln as 81 digits, or "no soln".
+// output is collected in a large buffer and written in big blocks.
+// --unique also counts solns (stopping at 2) and writes "not unique"
+// for puzzles with more than one.
+//
+// stderr gets puzzles/s and p50/p99 time per puzzle. exits with 1 if any
+// line was malformed, had no soln or (with --unique) was not unique.
+///////////////////////////////////////////////////////////////////////////////
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<algorithm>
+#include<chrono>
+#include<vector>
+
+#include "solver.h"
+#include "probe.h"
+
+#define OUT_SIZE (1 << 16) // bytes written per write()
+
+struct input {
+  const char *data;
+  size_t size;
+  bool mapped;
+};
+
+// maps fd if it is a plain file, else reads it all into one buffer
+static bool load_input( int fd, input *in ) {
+  struct stat st;
+  if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) ) {
+    in->size = st.st_size;
+    in->mapped = true;
+    if(in->size == 0) { in->data = ""; return true; }
+
+    void *p = mmap(NULL, in->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(p == MAP_FAILED) { return false; }
+    madvise(p, in->size, MADV_SEQUENTIAL);
+    in->data = (const char *)p;
+    return true;
+  }
+
+  size_t cap = 1 << 20;
+  size_t len = 0;
+  char *buf = (char *)malloc(cap);
+  while(buf) {
+    if(len == cap) { buf = (char *)realloc(buf, cap *= 2); if(!buf) { break; } }
+    ssize_t n = read(fd, buf + len, cap - len);
+    if(n < 0) { break; }
+    if(n == 0) {
+      in->data = buf;
+      in->size = len;
+      in->mapped = false;
+      return true;
+    }
+    len += n;
+  }
+  free(buf);
+  return false;
+}
+
+struct output {
+  char buf[OUT_SIZE];
+  size_t len;
+};
+
+static void out_flush( output *out ) {
+  size_t done = 0;
+  while(done < out->len) {
+    ssize_t n = write(1, out->buf + done, out->len - done);
+    if(n <= 0) { perror("write"); exit(1); }
+    done += n;
+  }
+  out->len = 0;
+}
+
+static void out_line( output *out, const char *line, size_t len ) {
+  if(out->len + len + 1 > OUT_SIZE) { out_flush(out); }
+  memcpy(out->buf + out->len, line, len);
+  out->len += len;
+  out->buf[out->len++] = '\n';
+}
+
+// 81 squares from [p, end), false if the line is not a puzzle
+static bool parse_puzzle( const char *p, const char *end, uint8_t *cells ) {
+  if(end - p != 81) { return false; }
+  for( int i=0; i<81; ++i ) {
+    char c = p[i];
+    if(c >= '1' && c <= '9') { cells[i] = c - '0'; }
+    else if(c == '.' || c == '0') { cells[i] = 0; }
+    else { return false; }
+  }
+  return true;
+}
+
+int main( int argc, char **argv ) {
+  bool unique = false;
+  const char *path = NULL;
+
+  for( int i=1; i<argc; ++i ) {
+    if( strcmp(argv[i], "--unique") == 0 ) { unique = true; }
+    else if(argv[i][0] == '-' && argv[i][1] != 0) {
+      fprintf(stderr, "usage: sudoku-solve [--unique] [file]\n");
+      return 2;
+    }
+    else { path = argv[i]; }
+  }
+
+  int fd = 0;
+  if(path && strcmp(path, "-") != 0) {
+    fd = open(path, O_RDONLY);
+    if(fd < 0) {
+      fprintf(stderr, "cannot open %s\n", path);
+      return 1;
+    }
+  }
+
+  input in;
+  if( !load_input(fd, &in) ) {
+    fprintf(stderr, "cannot read %s\n", path ? path : "stdin");
+    return 1;
+  }
+
+  static output out;
+  out.len = 0;
+
+  // one timing per puzzle. a line is at least 82 bytes, so this never grows
+  std::vector<uint32_t> ns;
+  ns.reserve(in.size / 82 + 1);
+
+  int solved = 0, no_soln = 0, not_unique = 0, malformed = 0;
+
+  auto t0 = std::chrono::steady_clock::now();
+  const char *p = in.data;
+  const char *end = in.data + in.size;
+  while(p < end) {
+    const char *eol = (const char *)memchr(p, '\n', end - p);
+    if(!eol) { eol = end; }
+    const char *next = eol + 1;
+    if(eol > p && eol[-1] == '\r') { --eol; }
+
+    if(eol == p || *p == '#') { p = next; continue; }
+
+    uint8_t cells[81];
+    if( !parse_puzzle(p, eol, cells) ) {
+      fprintf(stderr, "malformed line: %.*s\n", (int)(eol - p), p);
+      malformed++;
+      p = next;
+      continue;
+    }
+    p = next;
+
+    auto s0 = std::chrono::steady_clock::now();
+    solver_state s;
+    bool ok = solver_load(&s, cells) && solver_solve(&s, SOLVER_MRV);
+    bool many = ok && unique && count_solutions(cells, 2) > 1;
+    auto s1 = std::chrono::steady_clock::now();
+    ns.push_back((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(s1 - s0).count());
+
+    if(!ok) { out_line(&out, "no soln", 7); no_soln++; continue; }
+    if(many) { out_line(&out, "not unique", 10); not_unique++; continue; }
+
+    char line[81];
+    for( int i=0; i<81; ++i ) { line[i] = '0' + s.cell[i]; }
+    out_line(&out, line, 81);
+    solved++;
+  }
+  out_flush(&out);
+  auto t1 = std::chrono::steady_clock::now();
+
+  if(in.mapped && in.size) { munmap((void *)in.data, in.size); }
+  else if(!in.mapped) { free((void *)in.data); }
+
+  size_t n = ns.size();
+  double secs = std::chrono::duration<double>(t1 - t0).count();
+  double p50 = 0, p99 = 0;
+  if(n) {
+    std::nth_element(ns.begin(), ns.begin() + n / 2, ns.end());
+    p50 = ns[n / 2] / 1000.0;
+    size_t k = (n * 99) / 100;
+    if(k >= n) { k = n - 1; }
+    std::nth_element(ns.begin(), ns.begin() + k, ns.end());
+    p99 = ns[k] / 1000.0;
+  }
+
+  fprintf(stderr, "%zu puzzles in %.3f s, %.1f puzzles/s, p50 %.1f us, p99 %.1f us\n",
+          n, secs, n / secs, p50, p99);
+  fprintf(stderr, "%d solved, %d no soln", solved, no_soln);
+  if(unique) { fprintf(stderr, ", %d not unique", not_unique); }
+  fprintf(stderr, ", %d malformed\n", malformed);
+  probe_print();
+
+  return (no_soln || not_unique || malformed) ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+#include "input.h"
+#include "hal.h"
+#include "probe.h"
+
+struct axis_state {
+  int8_t dir;        // -1, 0 or 1
+  uint16_t wait;     // ms to the next repeat
+  uint16_t interval; // ms between the next two repeats
+};
+
+static int centre[2];        // by axis, JOY_VERT and JOY_HORZ
+static input_repeat repeat;
+static volatile axis_state axes[2]; // dir is read by input_active()
+static volatile bool button = false; // debounced
+static uint8_t bounce = 0;           // samples the button read the other way
+
+static volatile uint8_t queue[INPUT_QUEUE];
+static volatile uint8_t head = 0; // next slot to write, only the timer changes it
+static volatile uint8_t tail = 0; // next slot to read, only input_next() changes it
+
+static void push( uint8_t event ) {
+  uint8_t next = (head + 1) & (INPUT_QUEUE - 1);
+  if(next == tail) {
+    PROBE_INC(PROBE_DROPPED);
+    return;
+  }
+  queue[head] = event;
+  head = next; // the event is in place before the reader can see it
+}
+
+void input_init( int horz_centre, int vert_centre, const input_repeat *r ) {
+  centre[JOY_VERT] = vert_centre;
+  centre[JOY_HORZ] = horz_centre;
+  repeat = *r;
+  hal_timer(input_sample, INPUT_SAMPLE_MS);
+}
+
+// less is up or left, as the stick reads
+static void sample_axis( int axis, uint8_t less, uint8_t more ) {
+  volatile axis_state *a = &axes[axis];
+  int pos = hal_joy_read(axis) - centre[axis];
+
+  int8_t dir = a->dir;
+  if(dir > 0 && pos < INPUT_BACK_AT) { dir = 0; }
+  if(dir < 0 && pos > -INPUT_BACK_AT) { dir = 0; }
+  if(dir == 0) {
+    if(pos >= INPUT_PUSH_AT) { dir = 1; }
+    else if(pos <= -INPUT_PUSH_AT) { dir = -1; }
+  }
+
+  if(dir != a->dir) {
+    a->dir = dir;
+    if(dir == 0) { return; }
+    push(dir < 0 ? less : more);
+    a->wait = repeat.delay;
+    a->interval = repeat.start;
+    return;
+  }
+  if(dir == 0) { return; }
+
+  // held: repeat, a step sooner each time
+  if(a->wait > INPUT_SAMPLE_MS) {
+    a->wait -= INPUT_SAMPLE_MS;
+    return;
+  }
+  push(dir < 0 ? less : more);
+  a->wait = a->interval;
+  a->interval = (a->interval >= repeat.min + repeat.step) ? a->interval - repeat.step : repeat.min;
+}
+
+void input_sample() {
+  sample_axis(JOY_VERT, INPUT_UP, INPUT_DOWN);
+  sample_axis(JOY_HORZ, INPUT_LEFT, INPUT_RIGHT);
+
+  bool down = hal_joy_pressed();
+  if(down == button) {
+    bounce = 0;
+    return;
+  }
+  if(++bounce < INPUT_DEBOUNCE) { return; }
+  bounce = 0;
+  button = down;
+  push(down ? INPUT_PRESS : INPUT_RELEASE);
+}
+
+bool input_next( uint8_t *event ) {
+  uint8_t t = tail;
+  if(t == head) { return false; }
+  *event = queue[t];
+  tail = (t + 1) & (INPUT_QUEUE - 1);
+  return true;
+}
+
+bool input_active() {
+  return axes[JOY_VERT].dir || axes[JOY_HORZ].dir || button;
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// joystick input
+//
+// input_sample() runs every INPUT_SAMPLE_MS off the timer of hal.h (an
+// interrupt on the Mega), reads the stick and the button, and turns them
+// into events on a queue the main loop drains with input_next():
+//
+// > an axis counts as pushed once it is INPUT_PUSH_AT from its centre,
+//   and as back once it is within INPUT_BACK_AT. the gap between the two
+//   keeps a stick resting near one threshold from flickering
+// > the button changes state once INPUT_DEBOUNCE samples in a row agree.
+//   it gives one INPUT_PRESS when it goes down and one INPUT_RELEASE when
+//   it comes up, however long it is held
+// > a push gives one INPUT_MOVE at once. held, it moves again after
+//   repeat.delay ms, then every repeat.start ms, each time repeat.step ms
+//   sooner, down to every repeat.min ms
+//
+// the queue is a ring of INPUT_QUEUE events with one writer (the timer)
+// and one reader (the main loop). each side only writes its own 8-bit
+// index, and the AVR reads and writes a byte in one instruction, so
+// neither side turns interrupts off. a full queue drops the new event
+// and counts it (PROBE_DROPPED). drained every few ms, it never fills.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include<stdint.h>
+
+#define INPUT_SAMPLE_MS 4   // both axes and the button every 4ms
+#define INPUT_PUSH_AT   192 // of 512 from the centre
+#define INPUT_BACK_AT   96
+#define INPUT_DEBOUNCE  3   // samples, 12ms
+#define INPUT_QUEUE     16  // events, a power of two
+
+// events: a move with its direction, or the button
+#define INPUT_UP      0
+#define INPUT_DOWN    1
+#define INPUT_LEFT    2
+#define INPUT_RIGHT   3
+#define INPUT_PRESS   4
+#define INPUT_RELEASE 5
+
+// auto-repeat of a held stick, in ms
+struct input_repeat {
+  uint16_t delay; // push to the first repeat
+  uint16_t start; // first repeat to the second
+  uint16_t min;   // fastest
+  uint16_t step;  // each repeat this much sooner than the last
+};
+
+// starts sampling around the centres the stick reads at rest
+void input_init( int horz_centre, int vert_centre, const input_repeat *repeat );
+
+// one sample, called by the timer
+void input_sample();
+
+// takes the oldest event off the queue
+// false --> none
+bool input_next( uint8_t *event );
+
+// stick off centre or button down, as of the last sample
+bool input_active();
+
+#endif
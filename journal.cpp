@@ -0,0 +1,46 @@
+#include "journal.h"
+
+static uint8_t slot( const journal *j, uint8_t k ) {
+  return (j->head + k) % JOURNAL_SIZE;
+}
+
+void journal_clear( journal *j ) {
+  j->head = 0;
+  j->count = 0;
+  j->redo = 0;
+}
+
+void journal_record( journal *j, uint8_t i, uint8_t old_n, uint8_t new_n ) {
+  j->redo = 0;
+
+  // the same square as the last move --> that move goes further
+  if(j->count) {
+    uint16_t *last = &j->delta[slot(j, j->count - 1)];
+    if(journal_square(*last) == i) {
+      old_n = journal_old(*last);
+      if(old_n == new_n) { j->count--; } // back where it was
+      else { *last = journal_pack(i, old_n, new_n); }
+      return;
+    }
+  }
+
+  if(j->count == JOURNAL_SIZE) { j->head = slot(j, 1); } // forget the oldest
+  else { j->count++; }
+  j->delta[slot(j, j->count - 1)] = journal_pack(i, old_n, new_n);
+}
+
+bool journal_undo( journal *j, uint16_t *d ) {
+  if(j->count == 0) { return false; }
+  j->count--;
+  j->redo++;
+  *d = j->delta[slot(j, j->count)];
+  return true;
+}
+
+bool journal_redo( journal *j, uint16_t *d ) {
+  if(j->redo == 0) { return false; }
+  *d = j->delta[slot(j, j->count)];
+  j->count++;
+  j->redo--;
+  return true;
+}
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// undo/redo journal
+//
+// a ring of the last JOURNAL_SIZE moves on the player's board. a move is
+// one 16-bit delta: square (7 bits), old value (4 bits), new value (4
+// bits). undo and redo take one delta off either side of the current
+// position in O(1). a new move drops whatever could still be redone, and
+// a full ring forgets its oldest move. pressing on the same square again
+// changes the last move instead of adding one, so cycling a square from
+// 0 to 9 costs one delta, not ten.
+//
+// JOURNAL_SIZE * 2 bytes of SRAM and a few more, see journal_bytes().
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include<stdint.h>
+
+#define JOURNAL_SIZE 128 // moves, at most 255
+
+struct journal {
+  uint16_t delta[JOURNAL_SIZE];
+  uint8_t head;  // slot of the oldest move
+  uint8_t count; // moves that can be undone
+  uint8_t redo;  // undone moves after them that can be redone
+};
+
+inline uint16_t journal_pack( uint8_t i, uint8_t old_n, uint8_t new_n ) {
+  return ((uint16_t)i << 8) | (old_n << 4) | new_n;
+}
+inline uint8_t journal_square( uint16_t d ) { return d >> 8; }
+inline uint8_t journal_old( uint16_t d ) { return (d >> 4) & 0x0F; }
+inline uint8_t journal_new( uint16_t d ) { return d & 0x0F; }
+
+// nothing to undo or redo
+void journal_clear( journal *j );
+
+// square i went from old_n to new_n
+void journal_record( journal *j, uint8_t i, uint8_t old_n, uint8_t new_n );
+
+// the move to take back (put journal_old() on journal_square())
+// false --> nothing to undo
+bool journal_undo( journal *j, uint16_t *d );
+
+// the move to make again (put journal_new() on journal_square())
+// false --> nothing to redo
+bool journal_redo( journal *j, uint16_t *d );
+
+inline int journal_bytes() { return sizeof(journal); }
+
+#endif
@@ -0,0 +1,21 @@
+#include<string.h>
+
+#include "notes.h"
+#include "board.h"
+
+void notes_clear( notes *p ) {
+  memset(p->mask, 0, sizeof(p->mask));
+}
+
+void notes_place( notes *p, uint8_t i, uint8_t n ) {
+  uint16_t keep = ~((uint16_t)1 << (n - 1));
+  uint8_t row = board_row(i), col = board_col(i), box = board_box(i);
+
+  // 8 on the row, 8 on the col, and the 4 of the box on neither
+  for( int k=0; k<9; ++k ) {
+    uint8_t r = board_unit(row, k), c = board_unit(9 + col, k), b = board_unit(18 + box, k);
+    if(r != i) { p->mask[r] &= keep; }
+    if(c != i) { p->mask[c] &= keep; }
+    if(board_row(b) != row && board_col(b) != col) { p->mask[b] &= keep; }
+  }
+}
@@ -0,0 +1,31 @@
+///////////////////////////////////////////////////////////////////////////////
+// pencil marks
+//
+// the values the player notes down as still possible for each square,
+// 9 bits a square (bit n-1 == value n), 81*2 bytes. notes_place() takes a
+// value placed on a square off the notes of the 20 squares that see it
+// and looks at nothing else. a square keeps its own notes under a value,
+// so they come back if the value is taken off.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef NOTES_H
+#define NOTES_H
+
+#include<stdint.h>
+
+struct notes {
+  uint16_t mask[81];
+};
+
+// no notes anywhere
+void notes_clear( notes *p );
+
+// notes value n (1 to 9) on square i, or takes it off
+inline void notes_toggle( notes *p, uint8_t i, uint8_t n ) {
+  p->mask[i] ^= (uint16_t)1 << (n - 1);
+}
+
+// n was placed on square i
+void notes_place( notes *p, uint8_t i, uint8_t n );
+
+#endif
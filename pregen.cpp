@@ -0,0 +1,143 @@
+#include "pregen.h"
+#include "rate.h"
+#include "hal.h"
+#include "probe.h"
+
+static gen_state *gen = 0;
+static int strikes = 0;
+
+// ring of each level: ready[level][(head + k) % PREGEN_SLOTS], k < count
+static board ready[PREGEN_LEVELS][PREGEN_SLOTS];
+static uint8_t head[PREGEN_LEVELS];
+static uint8_t count[PREGEN_LEVELS];
+
+static bool busy = false;  // gen has a puzzle under way
+static int8_t urgent = -1; // level a player waits for
+
+pregen_stats pregen_stat;
+
+void pregen_init( gen_state *g, int n ) {
+  gen = g;
+  strikes = n;
+  for( int l=0; l<PREGEN_LEVELS; ++l ) {
+    head[l] = 0;
+    count[l] = 0;
+  }
+  busy = false;
+  urgent = -1;
+  pregen_reset_stats();
+}
+
+// a ring has room, or a player waits
+static bool wanted() {
+  if(urgent >= 0) { return true; }
+  for( int l=0; l<PREGEN_LEVELS; ++l ) {
+    if(count[l] < PREGEN_SLOTS) { return true; }
+  }
+  return false;
+}
+
+// finished puzzle of gen goes on the ring of the level it rates as
+static void push() {
+  busy = false;
+
+  uint8_t cells[81];
+  board_givens(&gen->puzzle, cells);
+  rate_result r;
+  if( !rate_puzzle(cells, &r) ) { return; } // can't happen, the soln is unique
+  int level = rate_level(&r);
+  if(count[level] == PREGEN_SLOTS) {
+    pregen_stat.dropped++;
+    return;
+  }
+
+  board *slot = &ready[level][(head[level] + count[level]) % PREGEN_SLOTS];
+  // soln values with the fixed bits of the puzzle, see board.h
+  *slot = gen->soln;
+  for( uint8_t i=0; i<sizeof(slot->fixed); ++i ) { slot->fixed[i] = gen->puzzle.fixed[i]; }
+
+  count[level]++;
+  pregen_stat.made++;
+  if(urgent == level) { urgent = -1; }
+}
+
+bool pregen_step() {
+  if(!gen) { return false; }
+
+  if(!busy) {
+    if(!wanted()) { return false; }
+    gen_start(gen, strikes);
+    busy = true;
+    return true;
+  }
+
+  PROBE_START(slice);
+  if( gen_step(gen) ) { push(); }
+  PROBE_STOP(PROBE_GEN, slice);
+  return true;
+}
+
+bool pregen_take( int level, board *soln ) {
+  if(count[level] == 0) { return false; }
+
+  *soln = ready[level][head[level]];
+  head[level] = (head[level] + 1) % PREGEN_SLOTS;
+  count[level]--;
+  return true;
+}
+
+bool pregen_pop( int level, board *soln ) {
+  pregen_stat.picks++;
+  if( !pregen_take(level, soln) ) { return false; }
+  pregen_stat.hits++;
+  return true;
+}
+
+// the puzzle under way may rate as level, so it is kept
+void pregen_rush( int level ) { urgent = level; }
+
+int pregen_progress( int level, int scale ) {
+  if(urgent != level || !busy) { return 0; }
+  return gen_progress(gen, scale);
+}
+
+void pregen_first_frame( uint32_t ms ) {
+  pregen_stat.frames++;
+  pregen_stat.last_ms = ms;
+  pregen_stat.total_ms += ms;
+  if(ms > pregen_stat.max_ms) { pregen_stat.max_ms = ms; }
+}
+
+void pregen_reset_stats() {
+  pregen_stat.picks = 0;
+  pregen_stat.hits = 0;
+  pregen_stat.made = 0;
+  pregen_stat.dropped = 0;
+  pregen_stat.frames = 0;
+  pregen_stat.last_ms = 0;
+  pregen_stat.max_ms = 0;
+  pregen_stat.total_ms = 0;
+  if(gen) { gen_reset_stats(gen); }
+}
+
+static void print_count( const char *label, uint32_t n, const char *unit ) {
+  hal_serial_print(label);
+  hal_serial_number(n);
+  hal_serial_print(unit);
+}
+
+void pregen_print_stats() {
+  print_count("pregen: hits ", pregen_stat.hits, "");
+  print_count("/", pregen_stat.picks, "");
+  print_count(", made ", pregen_stat.made, "");
+  print_count(", dropped ", pregen_stat.dropped, "");
+  print_count(", first frame last ", pregen_stat.last_ms, "ms");
+  print_count(", avg ", pregen_stat.frames ? pregen_stat.total_ms / pregen_stat.frames : 0, "ms");
+  print_count(", max ", pregen_stat.max_ms, "ms\n");
+
+  const gen_stats *g = &gen->stats;
+  print_count("gen: checks/puzzle ", g->puzzles ? g->checks / g->puzzles : 0, "");
+  print_count(", max ", g->max_checks, "");
+  print_count(", pairs ", g->pairs, "");
+  print_count(", skipped ", g->skipped, "\n");
+}
@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// puzzles generated ahead of time
+//
+// keeps a small ring of ready puzzles for each difficulty level, filled
+// one gen_step() at a time while the game has nothing else to do. picking
+// a level then takes a puzzle off its ring at once, and only waits for
+// the generator when the ring is empty.
+//
+// the level of a puzzle is the one rate.h gives it, as for sudoku-gen and
+// the SD bank, not its number of givens. every puzzle is made with the
+// same strikes and rated once done (one rate_puzzle(), no bigger than a
+// solver call), then goes on the ring of its level, or is dropped if that
+// ring is full. at the fewest givens about 2 in 5 rate easy, 1 in 6
+// medium and 2 in 5 hard.
+//
+// a puzzle is stored as its soln with the givens fixed (one 52 byte
+// board), so PREGEN_LEVELS * PREGEN_SLOTS boards of SRAM in all.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef PREGEN_H
+#define PREGEN_H
+
+#include<stdint.h>
+
+#include "board.h"
+#include "generator.h"
+
+#define PREGEN_LEVELS 3 // easy, medium, hard
+#define PREGEN_SLOTS  2 // ready puzzles per level
+
+// counters since the last pregen_reset_stats()
+struct pregen_stats {
+  uint32_t picks;    // pregen_pop() calls, one per level picked
+  uint32_t hits;     // pops that found a ready puzzle
+  uint32_t made;     // puzzles put on a ring
+  uint32_t dropped;  // puzzles rated for a full ring
+  uint32_t frames;   // pick to first frame times taken
+  uint32_t last_ms;  // time from the pick to the first frame of the board
+  uint32_t max_ms;
+  uint32_t total_ms;
+};
+
+extern pregen_stats pregen_stat;
+
+// generates with g, every puzzle strikes out strikes squares
+// g is used by pregen_step() from then on
+void pregen_init( gen_state *g, int strikes );
+
+// one slice of work on the next puzzle
+// false --> every ring is full, nothing was done
+bool pregen_step();
+
+// takes the oldest ready puzzle of level off its ring into soln, in O(1)
+// and counts the pick as a hit or a miss
+// false --> ring is empty, see pregen_rush()
+bool pregen_pop( int level, board *soln );
+
+// pregen_pop() without counting, for a player already waiting on a miss
+bool pregen_take( int level, board *soln );
+
+// level's ring is empty and a player waits: pregen_step() keeps making
+// puzzles until one rates as level, even with every other ring full
+void pregen_rush( int level );
+
+// share of the puzzle being made so far, 0 to scale, while a player
+// waits for level. it starts over for each puzzle that rates otherwise
+int pregen_progress( int level, int scale );
+
+// time from a pick to the first frame of its board
+void pregen_first_frame( uint32_t ms );
+
+void pregen_reset_stats();
+
+// prints pregen_stat and the generator counters on serial
+void pregen_print_stats();
+
+#endif
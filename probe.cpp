@@ -0,0 +1,99 @@
+#include "probe.h"
+
+#ifdef PROBE
+
+#ifdef __AVR__
+#include "hal.h"
+#else
+#include<stdio.h>
+#endif
+
+PROBE_LOCAL probe_stats probe_stat;
+
+static const char *const counter_names[PROBE_COUNTERS] = {
+  "solve_nodes", "unique_nodes", "unique_checks", "rng", "rngesus", "overruns", "dropped"
+};
+static const char *const timer_names[PROBE_TIMERS] = { "gen", "redraw", "hint" };
+
+void probe_time( int t, uint32_t us ) {
+  probe_timer *p = &probe_stat.timer[t];
+  p->count++;
+  p->total_us += us;
+  if(us > p->max_us) { p->max_us = us; }
+}
+
+void probe_reset() {
+  probe_stat = probe_stats();
+}
+
+void probe_add( probe_stats *sum ) {
+  for( int c=0; c<PROBE_COUNTERS; ++c ) { sum->count[c] += probe_stat.count[c]; }
+  for( int t=0; t<PROBE_TIMERS; ++t ) {
+    probe_timer *p = &sum->timer[t];
+    const probe_timer *q = &probe_stat.timer[t];
+    p->count += q->count;
+    p->total_us += q->total_us;
+    if(q->max_us > p->max_us) { p->max_us = q->max_us; }
+  }
+}
+
+#ifdef __AVR__
+
+// probe: solve_nodes 123, ... gen 12/345/67us, ...
+// timers are count/avg/max
+void probe_print() {
+  hal_serial_print("probe:");
+  for( int c=0; c<PROBE_COUNTERS; ++c ) {
+    hal_serial_print(c ? ", " : " ");
+    hal_serial_print(counter_names[c]);
+    hal_serial_char(' ');
+    hal_serial_number(probe_stat.count[c]);
+  }
+  for( int t=0; t<PROBE_TIMERS; ++t ) {
+    const probe_timer *p = &probe_stat.timer[t];
+    hal_serial_print(", ");
+    hal_serial_print(timer_names[t]);
+    hal_serial_char(' ');
+    hal_serial_number(p->count);
+    hal_serial_char('/');
+    hal_serial_number(p->count ? p->total_us / p->count : 0);
+    hal_serial_char('/');
+    hal_serial_number(p->max_us);
+    hal_serial_print("us");
+  }
+  hal_serial_char('\n');
+}
+
+#else
+
+// {"probe":{"solve_nodes":123,...,"gen":{"count":12,"total_us":345,"max_us":67},...}}
+void probe_print( const probe_stats *sum ) {
+  fprintf(stderr, "{\"probe\":{");
+  for( int c=0; c<PROBE_COUNTERS; ++c ) {
+    fprintf(stderr, "%s\"%s\":%lu", c ? "," : "", counter_names[c], (unsigned long)sum->count[c]);
+  }
+  for( int t=0; t<PROBE_TIMERS; ++t ) {
+    const probe_timer *p = &sum->timer[t];
+    fprintf(stderr, ",\"%s\":{\"count\":%lu,\"total_us\":%lu,\"max_us\":%lu}", timer_names[t],
+            (unsigned long)p->count, (unsigned long)p->total_us, (unsigned long)p->max_us);
+  }
+  fprintf(stderr, "}}\n");
+}
+
+void probe_print() {
+  probe_print(&probe_stat);
+}
+
+#endif
+
+#else
+
+void probe_time( int t, uint32_t us ) {}
+void probe_reset() {}
+void probe_add( probe_stats *sum ) {}
+void probe_print() {}
+#ifndef __AVR__
+void probe_print( const probe_stats *sum ) {}
+#endif
+
+#endif
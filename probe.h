@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// instrumentation
+//
+// counters and timers for where the time goes, kept since startup (or the
+// last probe_reset()). build with PROBE defined to keep them: add it to
+// DEFINITIONS in the Makefile, or make host HOST_CXXFLAGS="-O2 -g -DPROBE"
+// after a make host-clean. without it every PROBE_ macro is empty and no
+// code or SRAM is spent on them.
+//
+// probe_print() sends one compact line over serial on the Mega, and one
+// JSON object to stderr on the host. the host tools print the same JSON,
+// summed over their threads (counters are per thread on the host).
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include<stdint.h>
+
+// counters
+#define PROBE_SOLVE_NODES   0 // values tried by solver_solve()
+#define PROBE_UNIQUE_NODES  1 // values tried counting solns (test_unique etc.)
+#define PROBE_UNIQUE_CHECKS 2 // uniqueness checks while striking out squares
+#define PROBE_RNG           3 // rng_next() numbers
+#define PROBE_RNGESUS       4 // RNGesus() seeds from analog noise
+#define PROBE_OVERRUNS      5 // board frames drawn a period or more late
+#define PROBE_DROPPED       6 // joystick events lost to a full queue (input.h)
+#define PROBE_COUNTERS      7
+
+// timers
+#define PROBE_GEN    0 // one slice of puzzle generation
+#define PROBE_REDRAW 1 // one frame of the board
+#define PROBE_HINT   2 // one hint_step()
+#define PROBE_TIMERS 3
+
+struct probe_timer {
+  uint32_t count;
+  uint32_t total_us;
+  uint32_t max_us;
+};
+
+struct probe_stats {
+  uint32_t count[PROBE_COUNTERS];
+  probe_timer timer[PROBE_TIMERS];
+};
+
+#ifdef PROBE
+
+#ifdef __AVR__
+#define PROBE_LOCAL
+#else
+#define PROBE_LOCAL thread_local // the host tools generate on several threads
+#endif
+
+extern PROBE_LOCAL probe_stats probe_stat;
+
+#define PROBE_ADD(c, n) (probe_stat.count[c] += (n))
+#define PROBE_INC(c) (probe_stat.count[c]++)
+// PROBE_START(x) ... PROBE_STOP(PROBE_GEN, x) times the code in between,
+// only where hal.h is there
+#define PROBE_START(name) unsigned long probe_##name = hal_micros()
+#define PROBE_STOP(t, name) probe_time(t, hal_micros() - probe_##name)
+
+#else
+
+#define PROBE_ADD(c, n) ((void)sizeof(n)) // n is not evaluated
+#define PROBE_INC(c) ((void)0)
+#define PROBE_START(name) ((void)0)
+#define PROBE_STOP(t, name) ((void)0)
+
+#endif
+
+// adds one timing to a timer
+void probe_time( int t, uint32_t us );
+
+void probe_reset();
+
+// adds this thread's counters to *sum
+void probe_add( probe_stats *sum );
+
+// the counters of this thread, or sum on the host, see above
+// nothing without PROBE
+void probe_print();
+#ifndef __AVR__
+void probe_print( const probe_stats *sum );
+#endif
+
+#endif
@@ -0,0 +1,353 @@
+#include<stddef.h>
+
+#include "rate.h"
+#include "board.h"
+
+static uint16_t bit( uint8_t n ) { return (uint16_t)1 << (n - 1); }
+static int count( uint16_t mask ) { return __builtin_popcount(mask); }
+
+// units: rows 0 to 8, cols 9 to 17, boxes 18 to 26 (see board.h)
+static bool in_unit( uint8_t u, uint8_t i ) {
+  if(u < 9) { return board_row(i) == u; }
+  if(u < 18) { return board_col(i) == u - 9; }
+  return board_box(i) == u - 18;
+}
+
+// square i is one the step follows from
+static void why_cell( rate_why *why, uint8_t i ) {
+  if(why) { why->cells[i >> 3] |= 1 << (i & 7); }
+}
+
+void rate_clear( rate_grid *g ) {
+  for( uint8_t i=0; i<81; ++i ) {
+    g->cell[i] = 0;
+    g->cand[i] = 0x1FF;
+  }
+  g->left = 81;
+  g->bad = false;
+}
+
+void rate_place( rate_grid *g, uint8_t i, uint8_t n ) {
+  uint8_t units[3] = { board_row(i), (uint8_t)(9 + board_col(i)), (uint8_t)(18 + board_box(i)) };
+  uint16_t b = bit(n);
+
+  g->cell[i] = n;
+  g->cand[i] = 0;
+  g->left--;
+  for( int k=0; k<3; ++k ) {
+    for( int j=0; j<9; ++j ) {
+      uint8_t p = board_unit(units[k], j);
+      g->cand[p] &= ~b;
+      if(g->cell[p] == 0 && g->cand[p] == 0 && p != i) { g->bad = true; }
+    }
+  }
+}
+
+// removes values from square i, true if any were there
+static bool drop( rate_grid *g, uint8_t i, uint16_t values ) {
+  if( !(g->cand[i] & values) ) { return false; }
+  g->cand[i] &= ~values;
+  if(g->cand[i] == 0) { g->bad = true; }
+  return true;
+}
+
+// n on square i, of a step
+static void place( rate_grid *g, uint8_t i, uint8_t n, rate_why *why ) {
+  if(why) {
+    why->square = i;
+    why->value = n;
+  }
+  rate_place(g, i, n);
+}
+
+// the rest of unit u holds n or cannot
+static bool hidden_single( rate_grid *g, rate_why *why ) {
+  for( uint8_t u=0; u<27; ++u ) {
+    uint16_t once = 0, twice = 0, placed = 0;
+    for( int k=0; k<9; ++k ) {
+      uint8_t i = board_unit(u, k);
+      if(g->cell[i]) { placed |= bit(g->cell[i]); }
+      twice |= once & g->cand[i];
+      once |= g->cand[i];
+    }
+
+    // a value with nowhere to go
+    if( (once | placed) != 0x1FF ) { g->bad = true; return false; }
+
+    uint16_t hidden = once & ~twice;
+    if(!hidden) { continue; }
+    uint16_t b = hidden & -hidden;
+    for( int k=0; k<9; ++k ) {
+      uint8_t i = board_unit(u, k);
+      if(g->cand[i] & b) {
+        for( int j=0; j<9; ++j ) {
+          if(j != k) { why_cell(why, board_unit(u, j)); }
+        }
+        place(g, i, __builtin_ctz(b) + 1, why);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// the squares that see i hold the other 8 values
+static bool naked_single( rate_grid *g, rate_why *why ) {
+  for( uint8_t i=0; i<81; ++i ) {
+    if(g->cell[i] == 0 && count(g->cand[i]) == 1) {
+      uint8_t units[3] = { board_row(i), (uint8_t)(9 + board_col(i)), (uint8_t)(18 + board_box(i)) };
+      for( int k=0; k<3; ++k ) {
+        for( int j=0; j<9; ++j ) {
+          uint8_t p = board_unit(units[k], j);
+          if(g->cell[p]) { why_cell(why, p); }
+        }
+      }
+      place(g, i, __builtin_ctz(g->cand[i]) + 1, why);
+      return true;
+    }
+  }
+  return false;
+}
+
+// pointing: a value of a box only on one line --> not elsewhere on the line
+// claiming: a value of a line only in one box --> not elsewhere in the box
+static bool locked( rate_grid *g, rate_why *why ) {
+  for( uint8_t u=0; u<27; ++u ) {
+    for( uint8_t n=1; n<=9; ++n ) {
+      uint16_t b = bit(n);
+
+      // unit of the other kind all the squares of n share
+      int8_t row = -1, col = -1, box = -1;
+      int found = 0;
+      for( int k=0; k<9; ++k ) {
+        uint8_t i = board_unit(u, k);
+        if( !(g->cand[i] & b) ) { continue; }
+        int8_t r = board_row(i), c = board_col(i), x = board_box(i);
+        if(found == 0) { row = r; col = c; box = x; }
+        else {
+          if(row != r) { row = -1; }
+          if(col != c) { col = -1; }
+          if(box != x) { box = -1; }
+        }
+        found++;
+      }
+      if(found < 2) { continue; }
+
+      int8_t other = -1;
+      if(u >= 18) {
+        if(row >= 0) { other = row; }
+        else if(col >= 0) { other = 9 + col; }
+      }
+      else if(box >= 0) { other = 18 + box; }
+      if(other < 0) { continue; }
+
+      bool changed = false;
+      for( int k=0; k<9; ++k ) {
+        uint8_t i = board_unit(other, k);
+        if( !in_unit(u, i) && drop(g, i, b) ) { changed = true; }
+      }
+      if(!changed) { continue; }
+      for( int k=0; k<9; ++k ) {
+        uint8_t i = board_unit(u, k);
+        if(g->cand[i] & b) { why_cell(why, i); }
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// n squares of a unit holding only n values between them
+// --> the values go nowhere else in the unit
+static bool naked_subset( rate_grid *g, int n, rate_why *why ) {
+  for( uint8_t u=0; u<27; ++u ) {
+    uint8_t sq[9];
+    int m = 0;
+    for( int k=0; k<9; ++k ) {
+      uint8_t i = board_unit(u, k);
+      int c = count(g->cand[i]);
+      if(c >= 2 && c <= n) { sq[m++] = i; }
+    }
+
+    // c only runs once, unused, for pairs
+    for( int a=0; a<m; ++a ) {
+      for( int b=a+1; b<m; ++b ) {
+        for( int c=(n == 3 ? b+1 : m-1); c<m; ++c ) {
+          uint16_t values = g->cand[sq[a]] | g->cand[sq[b]];
+          if(n == 3) { values |= g->cand[sq[c]]; }
+          if(count(values) != n) { continue; }
+
+          bool changed = false;
+          for( int k=0; k<9; ++k ) {
+            uint8_t i = board_unit(u, k);
+            if(i == sq[a] || i == sq[b] || (n == 3 && i == sq[c])) { continue; }
+            if( drop(g, i, values) ) { changed = true; }
+          }
+          if(!changed) { continue; }
+          why_cell(why, sq[a]);
+          why_cell(why, sq[b]);
+          if(n == 3) { why_cell(why, sq[c]); }
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+// n values of a unit fitting only the same n squares
+// --> those squares hold nothing else
+static bool hidden_subset( rate_grid *g, int n, rate_why *why ) {
+  for( uint8_t u=0; u<27; ++u ) {
+    // squares of each value, bit k == square k of the unit
+    uint16_t where[9];
+    uint8_t vals[9];
+    int m = 0;
+    for( int v=0; v<9; ++v ) {
+      uint16_t w = 0;
+      for( int k=0; k<9; ++k ) {
+        if(g->cand[board_unit(u, k)] & (1 << v)) { w |= 1 << k; }
+      }
+      int c = count(w);
+      if(c >= 2 && c <= n) {
+        where[m] = w;
+        vals[m++] = v;
+      }
+    }
+
+    for( int a=0; a<m; ++a ) {
+      for( int b=a+1; b<m; ++b ) {
+        for( int c=(n == 3 ? b+1 : m-1); c<m; ++c ) {
+          uint16_t squares = where[a] | where[b];
+          uint16_t keep = (1 << vals[a]) | (1 << vals[b]);
+          if(n == 3) {
+            squares |= where[c];
+            keep |= 1 << vals[c];
+          }
+          if(count(squares) != n) { continue; }
+
+          bool changed = false;
+          for( int k=0; k<9; ++k ) {
+            if( (squares >> k) & 1 && drop(g, board_unit(u, k), ~keep & 0x1FF) ) { changed = true; }
+          }
+          if(!changed) { continue; }
+          for( int k=0; k<9; ++k ) {
+            if( (squares >> k) & 1 ) { why_cell(why, board_unit(u, k)); }
+          }
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+// a value on the same two cols of two rows --> not elsewhere on those
+// cols. and the same with rows and cols swapped
+static bool xwing( rate_grid *g, rate_why *why ) {
+  for( int lines=0; lines<2; ++lines ) { // 0: rows, 1: cols
+    for( uint8_t n=1; n<=9; ++n ) {
+      uint16_t b = bit(n);
+
+      // squares of n on each line, bit k == k-th square along the line
+      uint16_t where[9];
+      for( int l=0; l<9; ++l ) {
+        where[l] = 0;
+        for( int k=0; k<9; ++k ) {
+          uint8_t i = lines ? k*9 + l : l*9 + k;
+          if(g->cand[i] & b) { where[l] |= 1 << k; }
+        }
+      }
+
+      for( int l1=0; l1<9; ++l1 ) {
+        if(count(where[l1]) != 2) { continue; }
+        for( int l2=l1+1; l2<9; ++l2 ) {
+          if(where[l2] != where[l1]) { continue; }
+
+          bool changed = false;
+          for( int l=0; l<9; ++l ) {
+            if(l == l1 || l == l2) { continue; }
+            for( int k=0; k<9; ++k ) {
+              if( !((where[l1] >> k) & 1) ) { continue; }
+              uint8_t i = lines ? k*9 + l : l*9 + k;
+              if( drop(g, i, b) ) { changed = true; }
+            }
+          }
+          if(!changed) { continue; }
+          for( int k=0; k<9; ++k ) {
+            if( !((where[l1] >> k) & 1) ) { continue; }
+            why_cell(why, lines ? k*9 + l1 : l1*9 + k);
+            why_cell(why, lines ? k*9 + l2 : l2*9 + k);
+          }
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+int rate_step( rate_grid *g, rate_why *why ) {
+  if(why) {
+    why->square = 81;
+    why->value = 0;
+  }
+  if( hidden_single(g, why) ) { return RATE_HIDDEN_SINGLE; }
+  if(g->bad) { return RATE_GUESS; }
+  if( naked_single(g, why) ) { return RATE_NAKED_SINGLE; }
+  if( locked(g, why) ) { return RATE_LOCKED; }
+  if( naked_subset(g, 2, why) ) { return RATE_NAKED_PAIR; }
+  if( hidden_subset(g, 2, why) ) { return RATE_HIDDEN_PAIR; }
+  if( naked_subset(g, 3, why) ) { return RATE_NAKED_TRIPLE; }
+  if( hidden_subset(g, 3, why) ) { return RATE_HIDDEN_TRIPLE; }
+  if( xwing(g, why) ) { return RATE_XWING; }
+  return RATE_GUESS;
+}
+
+bool rate_puzzle( const uint8_t *cells, rate_result *r ) {
+  rate_grid g;
+  rate_clear(&g);
+
+  r->hardest = RATE_HIDDEN_SINGLE;
+  r->steps = 0;
+  for( int t=0; t<RATE_TECHNIQUES; ++t ) { r->uses[t] = 0; }
+
+  for( uint8_t i=0; i<81; ++i ) {
+    uint8_t n = cells[i];
+    if(n == 0) { continue; }
+    // given already used on its row, col or box
+    if( !(g.cand[i] & bit(n)) ) { return false; }
+    rate_place(&g, i, n);
+  }
+
+  while(g.left) {
+    int t = rate_step(&g, NULL);
+    if(g.bad) { return false; }
+    if(t > r->hardest) { r->hardest = t; }
+    if(t == RATE_GUESS) { break; }
+    r->steps++;
+    r->uses[t]++;
+  }
+  return true;
+}
+
+int rate_level( const rate_result *r ) {
+  if(r->hardest <= RATE_NAKED_SINGLE) { return RATE_EASY; }
+  if(r->hardest <= RATE_HIDDEN_TRIPLE) { return RATE_MEDIUM; }
+  return RATE_HARD;
+}
+
+const char *rate_name( int technique ) {
+  switch(technique) {
+    case RATE_HIDDEN_SINGLE: return "hidden single";
+    case RATE_NAKED_SINGLE:  return "naked single";
+    case RATE_LOCKED:        return "locked candidates";
+    case RATE_NAKED_PAIR:    return "naked pair";
+    case RATE_HIDDEN_PAIR:   return "hidden pair";
+    case RATE_NAKED_TRIPLE:  return "naked triple";
+    case RATE_HIDDEN_TRIPLE: return "hidden triple";
+    case RATE_XWING:         return "X-Wing";
+    case RATE_GUESS:         return "trial and error";
+  }
+  return "?";
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// difficulty rater
+//
+// solves a puzzle the way a person would, with a ranked set of techniques,
+// and rates it by the hardest technique it needed and the number of steps.
+// each step is the easiest technique that makes progress: a value placed,
+// or candidates removed. a puzzle none of them can finish needs trial and
+// error, RATE_GUESS.
+//
+// every square keeps a 9-bit candidate mask, as in solver.h. all state is
+// on the stack, nothing is allocated, so it runs inline in the batch
+// generator and on the Mega.
+//
+// rate_step() takes one step on a rate_grid the caller keeps, and can say
+// which squares the step follows from. the hints of hint.h use it.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef RATE_H
+#define RATE_H
+
+#include<stdint.h>
+
+// techniques, easiest first
+#define RATE_HIDDEN_SINGLE 0 // only square of a unit for a value
+#define RATE_NAKED_SINGLE  1 // only value left for a square
+#define RATE_LOCKED        2 // pointing and claiming: a value of a box on
+                             // one line, or of a line in one box
+#define RATE_NAKED_PAIR    3 // two squares of a unit with the same two values
+#define RATE_HIDDEN_PAIR   4 // two values of a unit in the same two squares
+#define RATE_NAKED_TRIPLE  5
+#define RATE_HIDDEN_TRIPLE 6
+#define RATE_XWING         7 // a value on two squares of two rows, same cols
+#define RATE_GUESS         8 // none of the above: trial and error
+#define RATE_TECHNIQUES    9
+
+// rated difficulty levels, the same order as generator.h
+#define RATE_EASY   0 // singles only
+#define RATE_MEDIUM 1 // locked candidates, pairs and triples
+#define RATE_HARD   2 // X-Wing or trial and error
+
+// a puzzle being solved
+struct rate_grid {
+  uint8_t cell[81];  // 0 == empty
+  uint16_t cand[81]; // values still possible, 0 on solved squares
+  uint8_t left;      // empty squares
+  bool bad;          // contradiction found --> no soln
+};
+
+// what a step did and why
+struct rate_why {
+  uint8_t square;    // square a value was placed on, 81 if candidates were removed
+  uint8_t value;
+  uint8_t cells[11]; // squares the step follows from: bit i%8 of cells[i/8]
+};
+
+struct rate_result {
+  uint8_t hardest; // RATE_HIDDEN_SINGLE etc.
+  uint16_t steps;  // techniques applied
+  uint16_t uses[RATE_TECHNIQUES]; // steps of each technique
+};
+
+// rates a puzzle of 81 values (0 == empty)
+// false --> the givens clash or the techniques ran into a contradiction,
+//           i.e. the puzzle has no soln
+bool rate_puzzle( const uint8_t *cells, rate_result *r );
+
+// empty grid, every value possible everywhere
+void rate_clear( rate_grid *g );
+
+// puts n on empty square i and drops it from the squares that see i
+void rate_place( rate_grid *g, uint8_t i, uint8_t n );
+
+// applies the easiest technique that makes progress and returns it
+// RATE_GUESS --> none did, g is unchanged, or g->bad is set
+// why: NULL, or set to the step. cells are only ever added to, so the
+//      squares of several steps can be gathered
+int rate_step( rate_grid *g, rate_why *why );
+
+// RATE_EASY, RATE_MEDIUM or RATE_HARD
+int rate_level( const rate_result *r );
+
+// one number to sort by: the hardest technique, then the steps
+inline uint16_t rate_score( const rate_result *r ) {
+  return (uint16_t)r->hardest * 256 + (r->steps < 255 ? r->steps : 255);
+}
+
+// "hidden single" etc.
+const char *rate_name( int technique );
+
+#endif
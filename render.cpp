@@ -0,0 +1,255 @@
+#include "render.h"
+#include "glyph.h"
+#include "hal.h"
+
+#define BLACK 0x0000
+#define WHITE 0xFFFF
+#define RED   0xF800 // hal_color(0xff, 0x00, 0x00)
+
+// shadow of a square: value, fixed and cursor bits
+#define SHOWN_VALUE   0x0F
+#define SHOWN_FIXED   0x10
+#define SHOWN_CURSOR  0x20
+#define SHOWN_CONFLICT 0x40
+#define SHOWN_HINT    0x80
+#define SHOWN_UNKNOWN 0xFF // screen was drawn over
+
+#define BUTTONS 6
+#define BUTTON_W 42
+#define BUTTON_H 17
+
+// top left of each button: QUIT, VERIFY, HINT, NOTE, undo, redo
+static const uint8_t button_x[BUTTONS] = { 0, 42, 84, 0, 42, 84 };
+static const uint8_t button_y[BUTTONS] = { 126, 126, 126, 143, 143, 143 };
+
+static uint8_t shown[81];
+static uint16_t shown_notes[81]; // notes drawn on each square
+static uint8_t button_shown[BUTTONS]; // SHOWN_CURSOR, 0 or SHOWN_UNKNOWN
+static bool frame_ok = false;         // right strip, bottom, button labels
+static uint8_t pen_shown = 0;         // on the NOTE button
+static bool started = false;          // shown[] holds something
+
+render_stats render_stat;
+
+void render_invalidate_all() {
+  for( int i=0; i<81; ++i ) { shown[i] = SHOWN_UNKNOWN; }
+  for( int i=0; i<BUTTONS; ++i ) { button_shown[i] = SHOWN_UNKNOWN; }
+  frame_ok = false;
+  started = true;
+}
+
+void render_invalidate( int x, int y, int w, int h ) {
+  if(w <= 0 || h <= 0) { return; }
+
+  // anything past the squares hits the frame and the buttons
+  if(x + w > 126 || y + h > 126) {
+    for( int i=0; i<BUTTONS; ++i ) { button_shown[i] = SHOWN_UNKNOWN; }
+    frame_ok = false;
+  }
+
+  if(x >= 126 || y >= 126) { return; }
+  int c0 = constrain(x / 14, 0, 8), c1 = constrain((x + w - 1) / 14, 0, 8);
+  int r0 = constrain(y / 14, 0, 8), r1 = constrain((y + h - 1) / 14, 0, 8);
+  for( int r=r0; r<=r1; ++r ) {
+    for( int c=c0; c<=c1; ++c ) { shown[r*9 + c] = SHOWN_UNKNOWN; }
+  }
+}
+
+// what square i should look like
+static uint8_t wanted( const board *b, const uint8_t *conflict, const uint8_t *marked,
+                       uint8_t i, int cursor ) {
+  uint8_t n = board_get(b, i);
+  uint8_t s = n;
+  if(n && board_is_fixed(b, i)) { s |= SHOWN_FIXED; }
+  if(conflict && (conflict[i >> 3] >> (i & 7)) & 1) { s |= SHOWN_CONFLICT; }
+  if(marked && (marked[i >> 3] >> (i & 7)) & 1) { s |= SHOWN_HINT; }
+  if(i == cursor) { s |= SHOWN_CURSOR; }
+  return s;
+}
+
+// notes square i should show
+static uint16_t wanted_notes( const board *b, const uint16_t *notes, uint8_t i ) {
+  return (notes && board_get(b, i) == 0) ? notes[i] : 0;
+}
+
+// one 14 pixel line y of a square, as draw_board() used to draw it:
+// the glyph (outline and value), then the 3x3 box lines
+static void square_line( uint16_t *px, uint8_t row, uint8_t col, uint8_t s, uint16_t notes,
+                         uint8_t y ) {
+  uint8_t edge = GLYPH_PLAIN;
+  if(s & SHOWN_CURSOR) { edge = GLYPH_CURSOR; }
+  else if(s & SHOWN_HINT) { edge = GLYPH_HINT; }
+  glyph_line(px, glyph_index(s & SHOWN_VALUE, s & SHOWN_FIXED, s & SHOWN_CONFLICT), edge, y);
+  if(y == 0 || y == 13) { return; }
+
+  // notes keep off pixel 1 where a box line is, else off pixel 12
+  if(notes) {
+    uint8_t x0 = (col == 3 || col == 6) ? 2 : 1;
+    uint8_t y0 = (row == 3 || row == 6) ? 2 : 1;
+    glyph_notes(px, notes, y, x0, y0);
+  }
+
+  // box lines at x, y = 40, 43, 82, 85 fall on pixel 12 of squares
+  // 2 and 5 and on pixel 1 of squares 3 and 6. the outline stays on top
+  if( (y == 12 && (row == 2 || row == 5)) || (y == 1 && (row == 3 || row == 6)) ) {
+    for( int x=1; x<13; ++x ) { px[x] = WHITE; }
+    return;
+  }
+  if(col == 2 || col == 5) { px[12] = WHITE; }
+  if(col == 3 || col == 6) { px[1] = WHITE; }
+}
+
+// squares c0 to c1 of rows r0 to r1 in one window, values and notes
+static void draw_squares( const board *b, const uint16_t *notes, const uint8_t *want,
+                          int r0, int r1, int c0, int c1 ) {
+  uint16_t line[9*14];
+  int w = (c1 - c0 + 1) * 14;
+
+  hal_window(c0*14, r0*14, w, (r1 - r0 + 1) * 14);
+  for( int r=r0; r<=r1; ++r ) {
+    uint16_t row_notes[9];
+    for( int c=c0; c<=c1; ++c ) { row_notes[c] = wanted_notes(b, notes, r*9 + c); }
+    for( int y=0; y<14; ++y ) {
+      for( int c=c0; c<=c1; ++c ) {
+        square_line(&line[(c - c0) * 14], r, c, want[r*9 + c], row_notes[c], y);
+      }
+      hal_push_pixels(line, w);
+    }
+    for( int c=c0; c<=c1; ++c ) {
+      shown[r*9 + c] = want[r*9 + c];
+      shown_notes[r*9 + c] = row_notes[c];
+    }
+  }
+
+  render_stat.bursts++;
+  render_stat.squares += (r1 - r0 + 1) * (c1 - c0 + 1);
+  render_stat.pixels += (uint32_t)w * (r1 - r0 + 1) * 14;
+}
+
+// "NOTE", or "NOTE n" while the button notes down n
+static void draw_pen( int pen ) {
+  char label[] = "NOTE  ";
+  hal_fill_rect(1, 144, BUTTON_W - 2, BUTTON_H - 2, BLACK);
+  if(pen) {
+    label[5] = '0' + pen;
+    hal_text(3, 148, 1, WHITE, BLACK, label);
+  }
+  else {
+    label[4] = '\0';
+    hal_text(9, 148, 1, WHITE, BLACK, label);
+  }
+  pen_shown = pen;
+}
+
+static void draw_frame( int pen ) {
+  hal_fill_rect(126, 0, 2, 126, BLACK);
+  hal_fill_rect(0, 126, 128, 34, BLACK);
+  for( int i=0; i<BUTTONS; ++i ) { hal_draw_rect(button_x[i], button_y[i], BUTTON_W, BUTTON_H, WHITE); }
+  hal_text(9, 131, 1, WHITE, BLACK, "QUIT");
+  hal_text(45, 131, 1, WHITE, BLACK, "VERIFY");
+  hal_text(93, 131, 1, WHITE, BLACK, "HINT");
+  hal_text(60, 148, 1, WHITE, BLACK, "<");
+  hal_text(102, 148, 1, WHITE, BLACK, ">");
+  draw_pen(pen);
+  for( int i=0; i<BUTTONS; ++i ) { button_shown[i] = 0; }
+  frame_ok = true;
+}
+
+void render_board( const board *b, const uint16_t *notes, const uint8_t *conflict,
+                   const uint8_t *marked, int pen, int cursor_x, int cursor_y ) {
+  unsigned long start = hal_micros();
+  bool drew = false;
+
+  if(!started) { render_invalidate_all(); }
+
+  int cursor = (cursor_y < 9) ? cursor_y*9 + cursor_x : -1;
+
+  // dirty squares of each row
+  uint8_t want[81];
+  uint16_t dirty[9];
+  for( int r=0; r<9; ++r ) {
+    dirty[r] = 0;
+    for( int c=0; c<9; ++c ) {
+      uint8_t i = r*9 + c;
+      want[i] = wanted(b, conflict, marked, i, cursor);
+      if(want[i] != shown[i] || wanted_notes(b, notes, i) != shown_notes[i]) { dirty[r] |= 1 << c; }
+    }
+  }
+
+  for( int r=0; r<9; ++r ) {
+    uint16_t mask = dirty[r];
+    if(mask == 0) { continue; }
+    drew = true;
+
+    int c0 = __builtin_ctz(mask);
+    uint16_t run = mask >> c0;
+    if( (run & (run + 1)) == 0 ) {
+      // one run --> take the rows below with the same run along
+      int c1 = c0 + __builtin_popcount(run) - 1;
+      int r1 = r;
+      while(r1 < 8 && dirty[r1 + 1] == mask) { r1++; }
+      draw_squares(b, notes, want, r, r1, c0, c1);
+      r = r1;
+      continue;
+    }
+
+    // several runs on this row, one window each
+    while(mask) {
+      c0 = __builtin_ctz(mask);
+      int c1 = c0;
+      while(c1 < 8 && (mask >> (c1 + 1)) & 1) { c1++; }
+      draw_squares(b, notes, want, r, r, c0, c1);
+      mask &= ~(((1 << (c1 + 1)) - 1) & ~((1 << c0) - 1));
+    }
+  }
+
+  if(!frame_ok) {
+    draw_frame(pen);
+    drew = true;
+  }
+  else if(pen != pen_shown) {
+    draw_pen(pen);
+    drew = true;
+  }
+
+  int button = (cursor_y >= 9) ? (cursor_y - 9) * 3 + cursor_x : -1;
+  for( int i=0; i<BUTTONS; ++i ) {
+    uint8_t s = (i == button) ? SHOWN_CURSOR : 0;
+    if(s == button_shown[i]) { continue; }
+    hal_draw_rect(button_x[i], button_y[i], BUTTON_W, BUTTON_H, s ? RED : WHITE);
+    button_shown[i] = s;
+    drew = true;
+  }
+
+  if(!drew) { return; }
+  uint32_t us = hal_micros() - start;
+  render_stat.frames++;
+  render_stat.last_us = us;
+  render_stat.total_us += us;
+  if(us > render_stat.max_us) { render_stat.max_us = us; }
+}
+
+void render_reset_stats() {
+  render_stat.frames = 0;
+  render_stat.bursts = 0;
+  render_stat.squares = 0;
+  render_stat.pixels = 0;
+  render_stat.last_us = 0;
+  render_stat.max_us = 0;
+  render_stat.total_us = 0;
+}
+
+static void print_count( const char *label, uint32_t n, const char *unit ) {
+  hal_serial_print(label);
+  hal_serial_number(n);
+  hal_serial_print(unit);
+}
+
+void render_print_stats() {
+  print_count("render: frames ", render_stat.frames, "");
+  print_count(", bursts ", render_stat.bursts, "");
+  print_count(", squares ", render_stat.squares, "");
+  print_count(", pixels ", render_stat.pixels, "");
+  print_count(", last ", render_stat.last_us, "us");
+  print_count(", max ", render_stat.max_us, "us\n");
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// board renderer
+//
+// keeps a shadow of what each board square (value and notes), the buttons
+// and the static frame look like on the screen, and only redraws what
+// differs from the board and cursor it is given. dirty squares next to
+// each other are sent as one address window and one burst of pixels (see
+// hal_window()), and a block of rows with the same dirty squares is sent
+// as one window too.
+//
+// anything that draws over the board without the renderer (menu, result
+// screens) must call render_invalidate() or render_invalidate_all() for
+// the area it covered, so that area is drawn again next time.
+//
+// board layout, in pixels:
+//   squares   14x14 at (col*14, row*14), value 6x8 at (+5, +4), or
+//             notes in a 3x3 grid (see glyph.h)
+//   3x3 boxes extra lines at x, y = 40, 43, 82, 85
+//   buttons   42x17, two rows of three at y = 126 and 143, x = 0, 42, 84:
+//             QUIT, VERIFY, HINT (cursor row 9), NOTE, undo (<) and
+//             redo (>) (cursor row 10)
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include<stdint.h>
+
+#include "board.h"
+
+// counters since the last render_reset_stats()
+struct render_stats {
+  uint32_t frames;   // render_board() calls that drew something
+  uint32_t bursts;   // address windows sent
+  uint32_t squares;  // squares redrawn
+  uint32_t pixels;   // pixels pushed in bursts
+  uint32_t last_us;  // time of the last frame that drew something
+  uint32_t max_us;   // slowest frame
+  uint32_t total_us; // all frames that drew something
+};
+
+extern render_stats render_stat;
+
+// whole screen was drawn over
+void render_invalidate_all();
+
+// a rectangle of the screen was drawn over
+void render_invalidate( int x, int y, int w, int h );
+
+// brings the screen up to date with board b and the cursor
+// notes:    81 masks as in notes.h, drawn on the empty squares
+//           NULL --> no notes
+// conflict: a bit per square as in check.h, its value is drawn as a clash
+//           NULL --> no clashes
+// marked:   the same, squares outlined in green (a hint, see hint.h)
+//           NULL --> none
+// pen:      value the NOTE button notes down, shown on it, 0 --> none
+// cursor_y == 9 or 10 --> cursor is on button cursor_x of that row
+void render_board( const board *b, const uint16_t *notes, const uint8_t *conflict,
+                   const uint8_t *marked, int pen, int cursor_x, int cursor_y );
+
+void render_reset_stats();
+
+// prints render_stat on serial
+void render_print_stats();
+
+#endif
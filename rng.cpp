@@ -0,0 +1,46 @@
+#include "rng.h"
+#include "probe.h"
+
+static inline uint32_t rotl( uint32_t x, int k ) { return (x << k) | (x >> (32 - k)); }
+
+// splitmix32: consecutive seeds still give unrelated states
+static uint32_t splitmix( uint32_t *x ) {
+  uint32_t z = (*x += 0x9E3779B9u);
+  z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+  z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+  return z ^ (z >> 16);
+}
+
+void rng_seed( rng_state *r, uint32_t seed ) {
+  for( int i=0; i<4; ++i ) { r->s[i] = splitmix(&seed); }
+
+  // all zero state never leaves zero
+  if( (r->s[0] | r->s[1] | r->s[2] | r->s[3]) == 0 ) { r->s[0] = 1; }
+}
+
+uint32_t rng_next( rng_state *r ) {
+  uint32_t *s = r->s;
+  PROBE_INC(PROBE_RNG);
+  uint32_t result = rotl(s[1] * 5, 7) * 9;
+  uint32_t t = s[1] << 9;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 11);
+
+  return result;
+}
+
+uint32_t rng_range( rng_state *r, uint32_t n ) {
+  // 2^32 is not a multiple of n. numbers below (2^32 % n) would make the
+  // small results a bit more likely, so draw again. for n = 9 that is
+  // 4 out of 2^32
+  uint32_t threshold = (0u - n) % n;
+  while(true) {
+    uint32_t x = rng_next(r);
+    if(x >= threshold) { return x % n; }
+  }
+}
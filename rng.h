@@ -0,0 +1,30 @@
+///////////////////////////////////////////////////////////////////////////////
+// seeded pseudo random numbers
+//
+// xoshiro128** (Blackman and Vigna): 16 bytes of state, 32-bit output,
+// only shifts, rotates, xors and one multiply per number, so it is cheap
+// on the Mega too. seed it once, e.g. from analog noise, then every number
+// costs microseconds instead of reading the noise pin.
+//
+// the same seed always gives the same numbers, on the Mega and the host.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef RNG_H
+#define RNG_H
+
+#include<stdint.h>
+
+struct rng_state {
+  uint32_t s[4];
+};
+
+// expands a 32-bit seed into the full state. any seed is fine, 0 included
+void rng_seed( rng_state *r, uint32_t seed );
+
+// next 32-bit number
+uint32_t rng_next( rng_state *r );
+
+// unbiased number from 0 to n-1, n > 0
+uint32_t rng_range( rng_state *r, uint32_t n );
+
+#endif
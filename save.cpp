@@ -0,0 +1,79 @@
+#include<string.h>
+
+#include "save.h"
+#include "hal.h"
+
+static uint8_t sum( const uint8_t *bytes ) {
+  uint8_t s = 0;
+  for( int k=0; k<SAVE_SIZE - 1; ++k ) { s += bytes[k]; }
+  return s;
+}
+
+// byte k of the image of s, k < SAVE_SIZE - 1 (all but the sum)
+static uint8_t image_byte( const save_game *s, int k ) {
+  if(k < 4) { return "SDKS"[k]; }
+  if(k == 4) { return SAVE_VERSION; }
+  if(k == 5) { return s->level; }
+  k -= 6;
+  if(k < (int)sizeof(board)) { return ((const uint8_t *)s->grid)[k]; }
+  k -= sizeof(board);
+  if(k < (int)sizeof(board)) { return ((const uint8_t *)s->soln)[k]; }
+  k -= sizeof(board);
+  uint16_t mask = s->pencil->mask[k >> 1];
+  return (k & 1) ? mask >> 8 : mask;
+}
+
+bool save_read( const uint8_t *bytes, save_game *s ) {
+  if( memcmp(bytes, "SDKS", 4) != 0 ) { return false; }
+  if(bytes[4] != SAVE_VERSION || bytes[5] > 2) { return false; }
+  if(bytes[SAVE_SIZE - 1] != sum(bytes)) { return false; }
+
+  s->level = bytes[5];
+  memcpy(s->grid, bytes + 6, sizeof(board));
+  memcpy(s->soln, bytes + 6 + sizeof(board), sizeof(board));
+  const uint8_t *p = bytes + 6 + 2*sizeof(board);
+  for( int i=0; i<81; ++i, p += 2 ) { s->pencil->mask[i] = p[0] | (p[1] << 8); }
+  return true;
+}
+
+void save_write( const save_game *s, uint8_t *bytes ) {
+  for( int k=0; k<SAVE_SIZE - 1; ++k ) { bytes[k] = image_byte(s, k); }
+  bytes[SAVE_SIZE - 1] = sum(bytes);
+}
+
+bool save_store( const save_game *s ) {
+  uint8_t fresh[SAVE_CHUNK], old[SAVE_CHUNK];
+  // no save area, or too small for the whole image
+  if( !hal_save_read(SAVE_SIZE - 1, old, 1) ) { return false; }
+
+  uint8_t total = 0;
+  for( int k=0; k<SAVE_SIZE - 1; ++k ) { total += image_byte(s, k); }
+
+  for( int pos=0; pos<SAVE_SIZE; pos+=SAVE_CHUNK ) {
+    int n = SAVE_SIZE - pos < SAVE_CHUNK ? SAVE_SIZE - pos : SAVE_CHUNK;
+    if( !hal_save_read(pos, old, n) ) { return false; }
+    for( int k=0; k<n; ++k ) {
+      fresh[k] = (pos + k == SAVE_SIZE - 1) ? total : image_byte(s, pos + k);
+    }
+
+    // runs of changed bytes
+    for( int k=0; k<n; ) {
+      if(fresh[k] == old[k]) { ++k; continue; }
+      int end = k;
+      while(end < n && fresh[end] != old[end]) { ++end; }
+      hal_save_write(pos + k, fresh + k, end - k);
+      k = end;
+    }
+  }
+  return true;
+}
+
+bool save_load( save_game *s ) {
+  uint8_t bytes[SAVE_SIZE];
+  return hal_save_read(0, bytes, SAVE_SIZE) && save_read(bytes, s);
+}
+
+void save_erase() {
+  uint8_t zero = 0;
+  hal_save_write(0, &zero, 1);
+}
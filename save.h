@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// saved game
+//
+// a snapshot of the game in progress, written to the save area of hal.h
+// (EEPROM on the Mega) every few seconds while the board changes, so a
+// game survives a power cycle. all of it fits in SAVE_SIZE bytes:
+//
+//     0   "SDKS"
+//     4   SAVE_VERSION
+//     5   difficulty level, 0 to 2
+//     6   player's board (see board.h): 41 bytes of packed values, then
+//         11 bytes of fixed bits
+//    58   soln, the same way
+//   110   player's notes (see notes.h), 2 bytes a square
+//   272   sum of bytes 0 to 271, mod 256
+//
+// the undo journal is not saved. only the bytes that changed are written,
+// on the Mega usually a square and the sum, so the EEPROM wears slowly
+// and a save takes a few ms. save_store() packs the image straight from
+// the game's boards and compares it SAVE_CHUNK bytes at a time, so a
+// save needs 2 chunks of stack, not 2 images.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SAVE_H
+#define SAVE_H
+
+#include<stdint.h>
+
+#include "board.h"
+#include "notes.h"
+
+#define SAVE_VERSION 2
+#define SAVE_SIZE    273
+#define SAVE_CHUNK   16
+
+// the parts of a game that are saved, where they live
+struct save_game {
+  uint8_t level;
+  board *grid;
+  board *soln;
+  notes *pencil;
+};
+
+// to and from SAVE_SIZE bytes
+// false --> no save there, or another version, or damaged, and s is
+//           unchanged
+bool save_read( const uint8_t *bytes, save_game *s );
+void save_write( const save_game *s, uint8_t *bytes );
+
+// writes s to the save area, only the bytes that differ from what is there
+// false --> there is no save area
+bool save_store( const save_game *s );
+
+// reads the save area
+// false --> no game saved
+bool save_load( save_game *s );
+
+// no game saved any more
+void save_erase();
+
+#endif
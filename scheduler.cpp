@@ -0,0 +1,49 @@
+#include<stddef.h>
+
+#include "scheduler.h"
+#include "hal.h"
+
+struct task {
+  sched_task fn;
+  unsigned long period;
+  unsigned long last; // millis of the last run
+};
+
+static task tasks[SCHED_TASKS];
+static int task_count = 0;
+static sched_idle_task idle = NULL;
+
+bool sched_every( sched_task fn, unsigned long period ) {
+  if(task_count == SCHED_TASKS) { return false; }
+  tasks[task_count].fn = fn;
+  tasks[task_count].period = period;
+  tasks[task_count].last = hal_millis() - period; // due now
+  task_count++;
+  return true;
+}
+
+void sched_idle( sched_idle_task fn ) {
+  idle = fn;
+}
+
+void sched_run() {
+  for( int i=0; i<task_count; ++i ) {
+    // unsigned differences stay right when millis wraps
+    unsigned long now = hal_millis();
+    if(now - tasks[i].last < tasks[i].period) { continue; }
+    tasks[i].last = now; // a late task does not run twice to catch up
+    tasks[i].fn();
+  }
+
+  if(idle && idle()) { return; }
+
+  // nothing to do until the next task is due
+  unsigned long now = hal_millis();
+  unsigned long wait = 0xFFFFFFFFUL;
+  for( int i=0; i<task_count; ++i ) {
+    unsigned long since = now - tasks[i].last;
+    unsigned long left = (since < tasks[i].period) ? tasks[i].period - since : 0;
+    if(left < wait) { wait = left; }
+  }
+  if(task_count && wait) { hal_delay(wait); }
+}
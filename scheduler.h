@@ -0,0 +1,32 @@
+///////////////////////////////////////////////////////////////////////////////
+// cooperative scheduler
+//
+// tasks are plain functions called from one loop, and none of them may
+// block. a periodic task runs every period millis. the idle task runs
+// whenever no periodic task is due and returns true while it has more
+// work; once it has none, sched_run() sleeps until the next periodic task
+// is due. a task runs late by at most the longest call of another task,
+// so long jobs (puzzle generation) are cut into short slices.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include<stdint.h>
+
+#define SCHED_TASKS 4 // periodic tasks
+
+typedef void (*sched_task)();
+typedef bool (*sched_idle_task)(); // true --> more work to do
+
+// adds a task that first runs on the next sched_run()
+// false --> SCHED_TASKS are already there
+bool sched_every( sched_task fn, unsigned long period );
+
+// sets the idle task, NULL for none
+void sched_idle( sched_idle_task fn );
+
+// runs the due tasks, then one slice of the idle task or sleeps
+void sched_run();
+
+#endif
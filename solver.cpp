@@ -0,0 +1,242 @@
+#include "solver.h"
+#include "probe.h"
+
+// one empty square on the row-major search stack
+struct solver_slot {
+  uint8_t row;
+  uint8_t col;
+  uint16_t cand; // values not yet tried
+};
+
+// one branch on the MRV search stack
+struct solver_level {
+  uint8_t row;
+  uint8_t col;
+  uint8_t mark;  // trail length before the branch
+  uint16_t cand; // values not yet tried
+};
+
+bool solver_load( solver_state *s, const uint8_t *cells ) {
+  for( int i=0; i<9; ++i ) {
+    s->row[i] = 0;
+    s->col[i] = 0;
+    s->box[i] = 0;
+  }
+  s->stats.nodes = 0;
+  s->stats.singles = 0;
+
+  for( int row=0; row<9; ++row ) {
+    for( int col=0; col<9; ++col ) {
+      uint8_t n = cells[row*9 + col];
+      s->cell[row*9 + col] = 0;
+      if(n == 0) { continue; }
+
+      // given already used on its row, col or box
+      if( !(solver_candidates(s, row, col) & solver_bit(n)) ) { return false; }
+      solver_place(s, row, col, n);
+    }
+  }
+  return true;
+}
+
+// walks the empty squares in row-major order
+static bool search_row_major( solver_state *s ) {
+  solver_slot stack[81];
+  int depth = 0; // number of empty squares
+
+  for( int row=0; row<9; ++row ) {
+    for( int col=0; col<9; ++col ) {
+      if( s->cell[row*9 + col] != 0 ) { continue; }
+      stack[depth].row = row;
+      stack[depth].col = col;
+      depth++;
+    }
+  }
+  if(depth == 0) { return true; }
+
+  // iterative instead of recursive so the Mega's stack stays small
+  int k = 0;
+  stack[0].cand = solver_candidates(s, stack[0].row, stack[0].col);
+
+  while(true) {
+    solver_slot *slot = &stack[k];
+
+    // no value left for this square --> undo the previous one
+    if(slot->cand == 0) {
+      if(k == 0) { return false; }
+      k--;
+      solver_remove(s, stack[k].row, stack[k].col);
+      continue;
+    }
+
+    // try the lowest remaining value
+    uint16_t bit = slot->cand & -slot->cand;
+    slot->cand &= ~bit;
+    solver_place(s, slot->row, slot->col, solver_value(bit));
+    s->stats.nodes++;
+
+    // sudoku is solved if all squares have a valid value
+    if(++k == depth) { return true; }
+
+    slot = &stack[k];
+    slot->cand = solver_candidates(s, slot->row, slot->col);
+  }
+}
+
+// candidates of an empty square by index
+static uint16_t index_candidates( const solver_state *s, int idx ) {
+  return ~( s->row[board_row(idx)] | s->col[board_col(idx)] | s->box[board_box(idx)] ) & SOLVER_ALL;
+}
+
+// places n on square idx and remembers it for undo
+static void trail_place( solver_state *s, uint8_t *trail, int *len, int idx, uint8_t n ) {
+  solver_place(s, board_row(idx), board_col(idx), n);
+  trail[(*len)++] = idx;
+}
+
+// undoes placements until the trail is mark long
+static void trail_undo( solver_state *s, const uint8_t *trail, int *len, int mark ) {
+  while(*len > mark) {
+    int idx = trail[--(*len)];
+    solver_remove(s, board_row(idx), board_col(idx));
+  }
+}
+
+// fills naked singles (one candidate left on a square) and hidden
+// singles (one square left for a value in a unit) until none are left
+// false --> some square or value has no place, the branch is dead
+static bool propagate( solver_state *s, uint8_t *trail, int *len ) {
+  bool changed = true;
+  while(changed) {
+    changed = false;
+
+    // naked singles
+    for( int idx=0; idx<81; ++idx ) {
+      if( s->cell[idx] != 0 ) { continue; }
+      uint16_t cand = index_candidates(s, idx);
+      if(cand == 0) { return false; }
+      if( (cand & (cand - 1)) == 0 ) {
+        trail_place(s, trail, len, idx, solver_value(cand));
+        s->stats.singles++;
+        changed = true;
+      }
+    }
+
+    // hidden singles, only once no naked single is left
+    if(changed) { continue; }
+    for( int u=0; u<27; ++u ) {
+      uint16_t used = 0;  // values already on the unit
+      uint16_t once = 0;  // candidates seen at least once
+      uint16_t twice = 0; // candidates seen at least twice
+      for( int i=0; i<9; ++i ) {
+        int idx = board_unit(u, i);
+        if( s->cell[idx] != 0 ) { used |= solver_bit( s->cell[idx] ); continue; }
+        uint16_t cand = index_candidates(s, idx);
+        twice |= once & cand;
+        once |= cand;
+      }
+      if( (used | once) != SOLVER_ALL ) { return false; }
+
+      uint16_t hidden = once & ~twice;
+      while(hidden) {
+        uint16_t bit = hidden & -hidden;
+        hidden &= ~bit;
+        for( int i=0; i<9; ++i ) {
+          int idx = board_unit(u, i);
+          if( s->cell[idx] == 0 && (index_candidates(s, idx) & bit) ) {
+            trail_place(s, trail, len, idx, solver_value(bit));
+            s->stats.singles++;
+            changed = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// propagates singles, then branches on the square with fewest candidates
+// returns the number of solns found, at most limit
+static int search_mrv( solver_state *s, int limit ) {
+  solver_level stack[81];
+  uint8_t trail[81]; // squares filled since the search started
+  int len = 0;
+  int k = 0;
+  int count = 0;
+
+  while(true) {
+    if( propagate(s, trail, &len) ) {
+      // pick the empty square with the fewest candidates
+      int best = -1;
+      int best_count = 10;
+      uint16_t best_cand = 0;
+      for( int idx=0; idx<81 && best_count > 2; ++idx ) {
+        if( s->cell[idx] != 0 ) { continue; }
+        uint16_t cand = index_candidates(s, idx);
+        int count = solver_count(cand);
+        if(count < best_count) {
+          best = idx;
+          best_count = count;
+          best_cand = cand;
+        }
+      }
+      if(best >= 0) {
+        stack[k].row = board_row(best);
+        stack[k].col = board_col(best);
+        stack[k].mark = len;
+        stack[k].cand = best_cand;
+        k++;
+      }
+      // sudoku is solved if no square is empty
+      else if(++count >= limit) { return count; }
+    }
+
+    // try the next value on the deepest branch, backtracking as needed
+    while(true) {
+      if(k == 0) {
+        trail_undo(s, trail, &len, 0);
+        return count;
+      }
+
+      solver_level *level = &stack[k - 1];
+      trail_undo(s, trail, &len, level->mark);
+      if(level->cand == 0) {
+        k--;
+        continue;
+      }
+
+      uint16_t bit = level->cand & -level->cand;
+      level->cand &= ~bit;
+      trail_place(s, trail, &len, level->row*9 + level->col, solver_value(bit));
+      s->stats.nodes++;
+      break;
+    }
+  }
+}
+
+bool solver_solve( solver_state *s, uint8_t mode ) {
+  uint32_t nodes = s->stats.nodes;
+  bool found = (mode == SOLVER_MRV) ? search_mrv(s, 1) > 0 : search_row_major(s);
+  PROBE_ADD(PROBE_SOLVE_NODES, s->stats.nodes - nodes);
+  return found;
+}
+
+int solver_count_solutions( solver_state *s, int limit ) {
+  uint32_t nodes = s->stats.nodes;
+  int count = search_mrv(s, limit);
+  PROBE_ADD(PROBE_UNIQUE_NODES, s->stats.nodes - nodes);
+  return count;
+}
+
+bool solver_load_board( solver_state *s, const board *b ) {
+  uint8_t cells[81];
+  board_givens(b, cells);
+  return solver_load(s, cells);
+}
+
+int count_solutions( const uint8_t *cells, int limit ) {
+  solver_state s;
+  if( !solver_load(&s, cells) ) { return 0; }
+  return solver_count_solutions(&s, limit);
+}
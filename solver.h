@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// bitmask solver core
+//
+// every row, col and 3x3 box keeps a 9-bit mask of the values it holds.
+// bit (n-1) set --> value n is already used in that row/col/box
+// candidates for a cell are then ~(row | col | box), no scanning needed.
+// masks are updated as values are placed and undone during the search.
+//
+// cells are indexed row-major: index = row*9 + col
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include<stdint.h>
+
+#include "board.h"
+
+#define SOLVER_ALL 0x1FF // values 1 to 9
+
+// search orders for solver_solve()
+#define SOLVER_ROW_MAJOR 0 // first empty square, the old solve_grid() order
+#define SOLVER_MRV       1 // square with fewest candidates, singles first
+
+// counters for the last search, reset by solver_load()
+struct solver_stats {
+  uint32_t nodes;   // values tried while branching
+  uint32_t singles; // values forced by naked or hidden singles
+};
+
+struct solver_state {
+  uint8_t cell[81]; // 0 == empty, else 1 to 9
+  uint16_t row[9];  // values used on each row
+  uint16_t col[9];  // values used on each col
+  uint16_t box[9];  // values used on each box
+  solver_stats stats;
+};
+
+// box index of a square: 0 to 8, left to right then top to bottom
+inline int solver_box( int row, int col ) { return (row / 3) * 3 + col / 3; }
+
+// mask for a value 1 to 9
+inline uint16_t solver_bit( uint8_t n ) { return (uint16_t)1 << (n - 1); }
+
+// value for the lowest set bit of a mask
+inline uint8_t solver_value( uint16_t mask ) { return __builtin_ctz(mask) + 1; }
+
+// number of values in a mask
+inline int solver_count( uint16_t mask ) { return __builtin_popcount(mask); }
+
+// values that can still go into an empty square
+inline uint16_t solver_candidates( const solver_state *s, int row, int col ) {
+  return ~( s->row[row] | s->col[col] | s->box[solver_box(row, col)] ) & SOLVER_ALL;
+}
+
+// puts n on a square and marks it used on its row, col and box
+inline void solver_place( solver_state *s, int row, int col, uint8_t n ) {
+  uint16_t bit = solver_bit(n);
+  s->cell[row*9 + col] = n;
+  s->row[row] |= bit;
+  s->col[col] |= bit;
+  s->box[solver_box(row, col)] |= bit;
+}
+
+// undoes solver_place()
+inline void solver_remove( solver_state *s, int row, int col ) {
+  uint16_t bit = ~solver_bit( s->cell[row*9 + col] );
+  s->cell[row*9 + col] = 0;
+  s->row[row] &= bit;
+  s->col[col] &= bit;
+  s->box[solver_box(row, col)] &= bit;
+}
+
+// fills the masks from 81 values (0 == empty)
+// false --> two givens clash, state is unusable
+// true ---> state is ready to solve
+bool solver_load( solver_state *s, const uint8_t *cells );
+
+// solver_load() with the fixed squares of a board, the rest are empty
+bool solver_load_board( solver_state *s, const board *b );
+
+// solves by backtracking, trying values from 1 to 9
+// SOLVER_ROW_MAJOR walks the empty squares in order and finds the same
+// soln as the old solve_grid()
+// SOLVER_MRV fills naked and hidden singles, then branches on the empty
+// square with the fewest candidates
+// false --> sudoku has no soln, s->cell is left as loaded
+// true ---> sudoku has a soln, s->cell holds it
+bool solver_solve( solver_state *s, uint8_t mode );
+
+// counts solns in MRV order, stopping as soon as limit are found
+// returns 0, 1 ... limit. s->cell holds the last soln found if the
+// limit was reached, else it is left as loaded
+int solver_count_solutions( solver_state *s, int limit );
+
+// counts solns of 81 values (0 == empty), stopping at limit
+// no shared state, safe to call from several threads at once
+// returns 0 if the givens clash
+int count_solutions( const uint8_t *cells, int limit );
+
+#endif
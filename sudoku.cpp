@@ -18,99 +18,125 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-#include<Arduino.h> // arduino library
+#include<stdlib.h>
+#include<string.h>
+
+#include "hal.h"    // display, joystick, clock and serial
+#include "generator.h"
+#include "render.h"   // redraws only what changed on the board
+#include "check.h"    // clashes and the end of the game as the player goes
+#include "journal.h"  // undo and redo
+#include "hint.h"     // the next step for a player who is stuck
+#include "notes.h"    // pencil marks
+#include "save.h"     // the game in progress survives a power cycle
+#include "pregen.h"   // puzzles made ahead of time
+#include "bank.h"     // puzzles from the SD card
+#include "scheduler.h"  // runs the tasks below from one loop
+#include "input.h"    // joystick events, sampled on a timer
+#include "probe.h"    // counters and timers, with PROBE defined
 
-#include<Adafruit_GFX.h>    // Core graphics library
-#include<Adafruit_ST7735.h> // Hardware-specific library
-#include<SPI.h>
-
-#define TFT_RST 8 // Reset line for TFT (or connect to +5V)
-#define TFT_DC  7 // Data/command line for TFT
-#define SD_CS   5 // Chip select line for SD card
-#define TFT_CS  6 // Chip select line for TFT display
-//dimensions of LCD screen
-#define TFT_WIDTH 128
-#define TFT_HEIGHT 160
-
-Adafruit_ST7735 tft = Adafruit_ST7735( TFT_CS, TFT_DC, TFT_RST );
-
-#define JOY_VERT_ANALOG 0
-#define JOY_HORZ_ANALOG 1
-#define JOY_SEL 9
 // joystick control
-#define JOY_DEADZONE 64
-#define MILLIS_PER_FRAME 50 // 20fps
+#define MILLIS_PER_SCAN 5   // the events of input.h are handled this often
+#define MILLIS_PER_FRAME 20 // 50fps, a frame only draws what changed
+#define MILLIS_COMPLETED 3000 // "COMPLETED!" stays up this long
+#define MILLIS_REST 300 // stick left alone this long --> generate in the background
+#define MILLIS_PER_SAVE 5000 // a changed board is saved this often
 
 int JOY_HORZ_CENTRE = 512;
 int JOY_VERT_CENTRE = 512;
 
+// a held stick moves again after 250ms, then every 150ms, 15ms sooner
+// each time, down to every 40ms
+const input_repeat JOY_REPEAT = { 250, 150, 40, 15 };
+
 int g_joyX = 0;    // initial X-position of cursor for Grid
 int g_joyY = 0;    // initial Y-position of cursor for Grid
 int g_cursorX = 0;
 int g_cursorY = 0;
 
-const uint16_t RED = tft.Color565( 0xff, 0x00, 0x00 );
+const uint16_t RED = hal_color( 0xff, 0x00, 0x00 );
 
 void scanJoystick();
 void updateNumber();
 void updateScreen();
 void drawScreen();
 
-void mode_menu();
+// game modes, one at a time. set_mode() switches
+#define MODE_MENU    0 // choose difficulty
+#define MODE_LOADING 1 // puzzle is being generated
+#define MODE_BOARD   2 // solving
+#define MODE_ERROR   3 // wrong soln, try again?
+#define MODE_DONE    4 // right soln
+
+int mode = MODE_MENU;
+unsigned long mode_since = 0; // millis mode was set
+bool mode_drawn = false;      // screen of the mode is up
+
+void set_mode( int m );
+
+// tasks, see scheduler.h
+void task_input();
+void task_draw();
+void task_save();
+bool task_generate();
+
+unsigned long joy_last_used = 0; // millis the stick was last off centre or pressed
+
+void handle_input( int dx, int dy, bool press );
+
 void draw_menu();
-void scanJoystick_menu();
+void scanJoystick_menu( int dy, bool press );
 void updateCursor_menu();
 int selected = 0;
 int old_selection = 0;
 
-void mode_board();
+void draw_loading();
+void scanJoystick_loading( bool press );
+int shown_progress = -1; // progress bar width on screen
+
 void draw_board();
-void scanJoystick_board();
+void scanJoystick_board( int dx, int dy, bool press );
 void updateCursor_board();
 void update_grid();
+void update_notes();
+void set_square( uint8_t i, uint8_t n );
+void find_hint();
 
-void mode_result();
 void draw_result_completed();
 void draw_result_error();
-void scanJoystick_result();
+void scanJoystick_result( int dx, bool press );
 void updateCursor_result();
 
-struct sudoku_grid {
-  uint8_t value;
-  bool fixed; // sizeof(bool) == 1 byte
-};
-sudoku_grid soln_grid[9][9]; // 0 to 8 by 0 to 8, occupies 162 bytes
-sudoku_grid grid[9][9];
-
-int difficulty = 0;
-const int easy   = 81 - 35;
-const int medium = 81 - 30;
-const int hard   = 81 - 25;
+board grid;    // player's board, 52 bytes (see board.h)
+board soln;    // soln of the current puzzle, givens are fixed
+check_state live; // values counted on grid, see check.h
+journal moves;    // player's moves on grid, for undo and redo
+hint_state help;  // candidates of grid and the hint shown, see hint.h
+notes pencil;     // player's notes on grid, 162 bytes
+int pen = 0;      // value a press on a square notes down, 0 --> presses change values
+int level = 0;    // difficulty of the current puzzle, 0 to 2
+bool save_dirty = false; // grid changed since it was last saved
+bool save_ok = false;    // a game is saved, CONTINUE is on the menu
+gen_state gen; // makes the puzzles of pregen.h
+
+bank_header bank;     // index of the puzzle bank on the SD card
+bool bank_ok = false; // card has a bank
+
+unsigned long frame_ms = 0; // millis of the last board frame
+unsigned long pick_ms = 0; // millis the difficulty was picked
+bool pick_timed = false;   // first frame after the pick not drawn yet
 
 void setup();
 void clear_grid();
-void empty_grid();
-void generate_grid();
-
-void random_gen_swap(int check);
-void row_swap(int k1, int k2);
-void col_swap(int k1,int k2);
 
-void random_gen_change(int check);
-void row_change(int k1,int k2);
-void col_change(int k1,int k2);
+uint32_t RNGesus();
 
-bool solve_grid(int row, int col);
-bool test_row(int row, int col);
-bool test_col(int row, int col);
-bool test_box(int row, int col);
+bool open_bank();
+bool load_from_bank( int level );
 
-int RNGesus();
-void reduce_grid();
-bool test_unique(int row, int col);
-int num_row;
-int num_col;
-uint8_t num_val;
+void store_game();
+bool resume_game();
+void undo_move( bool redo );
 
 void setup_grid();
 void print_grid();
@@ -119,243 +145,298 @@ bool test_soln();
 int main() {
   setup();
 
-  while(true) {
-    mode_menu();
+  // joystick and screen on a fixed tick, generation in between
+  sched_every(task_input, MILLIS_PER_SCAN);
+  sched_every(task_draw, MILLIS_PER_FRAME);
+  sched_every(task_save, MILLIS_PER_SAVE);
+  sched_idle(task_generate);
 
-    setup_grid();
+  // straight back into a game left by a power cycle
+  set_mode( resume_game() ? MODE_BOARD : MODE_MENU );
+  while(true) { sched_run(); }
 
-    mode_board();
-  }
-
-  Serial.end();  // terminate serial 1 communication
   return 0;      // no error
 }
 
 void setup() {
-  init();
-  Serial.begin(9600);        // initialize serial communication
-  tft.initR(INITR_BLACKTAB);
-
-  pinMode( JOY_SEL, INPUT );     // Init joystick
-  digitalWrite( JOY_SEL, HIGH ); // enables pull-up resistor
+  hal_init(); // serial, screen and joystick
 
   // calibrate joystick
-  Serial.print("Initializing Joystick. DO NOT TOUCH...");
-  JOY_HORZ_CENTRE = analogRead(JOY_HORZ_ANALOG);
-  JOY_VERT_CENTRE = analogRead(JOY_VERT_ANALOG);
-  Serial.println("OK!");
+  hal_serial_print("Initializing Joystick. DO NOT TOUCH...");
+  JOY_HORZ_CENTRE = hal_joy_read(JOY_HORZ);
+  JOY_VERT_CENTRE = hal_joy_read(JOY_VERT);
+  hal_serial_print("OK!\n");
 
-  tft.fillScreen(0x0000);
+  hal_fill_screen(0x0000);
 
   // fills the initialized 9x9 grid with "0"'"s and "false"
   clear_grid();
+
+  // seed the generator once, analog noise is too slow to use per number
+  gen_init(&gen, RNGesus());
+  pregen_init(&gen, GEN_HARD); // rated into levels, see pregen.h
+
+  // sampling reads the joystick pins from an interrupt, which would
+  // switch the ADC away from the noise pin in the middle of RNGesus()
+  input_init(JOY_HORZ_CENTRE, JOY_VERT_CENTRE, &JOY_REPEAT);
+
+  // pre-generated puzzles, if there is a card with a bank
+  bank_ok = open_bank();
+
+  hal_serial_print("Undo journal: ");
+  hal_serial_number(JOURNAL_SIZE);
+  hal_serial_print(" moves, ");
+  hal_serial_number(journal_bytes());
+  hal_serial_print(" bytes\n");
 }
 
-// opening screen. choosed difficulty
-void mode_menu() {
-  // reset selected and old_selection
-  selected = 0; // 0, 1, 2
-  old_selection = selected;
+// switches mode. its screen is drawn by the next task_draw()
+void set_mode( int m ) {
+  // frame times on serial-monitor
+  if(mode == MODE_BOARD && m != MODE_BOARD) {
+    render_print_stats();
+    pregen_print_stats();
+    probe_print();
+  }
+
+  if(m == MODE_MENU) {
+    // reset selected and old_selection
+    selected = 0; // 0, 1, 2
+    old_selection = selected;
+  }
+  if(m == MODE_LOADING) { shown_progress = -1; }
+  if(m == MODE_BOARD) {
+    // reset cursor to top left square
+    g_joyX = 0;
+    g_cursorX = g_joyX;
+    g_joyY = 0;
+    g_cursorY = g_joyY;
+    render_reset_stats();
+  }
+  if(m == MODE_ERROR) {
+    selected = 0; // YES
+    old_selection = selected;
+  }
+  if(m == MODE_MENU) { store_game(); } // CONTINUE picks it up
+  if(m == MODE_DONE) {
+    save_erase(); // nothing left to continue
+    save_ok = false;
+    save_dirty = false;
+  }
+
+  mode = m;
+  mode_since = hal_millis();
+  mode_drawn = false;
+}
+
+// hands the joystick events queued since the last scan to the mode, one
+// at a time, so none is lost when several came in
+void task_input() {
+  uint8_t event;
+  while( input_next(&event) ) {
+    if(event == INPUT_PRESS) { handle_input(0, 0, true); }
+    else if(event == INPUT_UP) { handle_input(0, -1, false); }
+    else if(event == INPUT_DOWN) { handle_input(0, 1, false); }
+    else if(event == INPUT_LEFT) { handle_input(-1, 0, false); }
+    else if(event == INPUT_RIGHT) { handle_input(1, 0, false); }
+  }
+  if( input_active() ) { joy_last_used = hal_millis(); }
+
+  if(mode == MODE_DONE && hal_millis() - mode_since >= MILLIS_COMPLETED) { set_mode(MODE_MENU); }
+}
+
+void handle_input( int dx, int dy, bool press ) {
+  if(mode == MODE_MENU) { scanJoystick_menu(dy, press); }
+  else if(mode == MODE_LOADING) { scanJoystick_loading(press); }
+  else if(mode == MODE_BOARD) { scanJoystick_board(dx, dy, press); }
+  else if(mode == MODE_ERROR) { scanJoystick_result(dx, press); }
+}
 
-  // display menu interface
-  draw_menu();
-
-  // user can now choose difficulty
-  while(true) {
-    // check for input
-    scanJoystick_menu();
-
-    // button press --> exit function
-    if( digitalRead(JOY_SEL) == LOW ) {
-      // feedback
-      tft.setTextSize(1);
-      tft.setTextColor(0xFFFF,0x0000);
-      tft.setCursor(28, 140);
-      tft.print("Loading...");
-
-      // set difficulty
-      if(selected == 0) { difficulty = easy; }
-      if(selected == 1) { difficulty = medium; }
-      if(selected == 2) { difficulty = hard; }
-      break; // end loop, function
+// brings the screen of the mode up to date
+void task_draw() {
+  if(mode == MODE_MENU) {
+    if(!mode_drawn) { draw_menu(); }
+    else if(old_selection != selected) { updateCursor_menu(); }
+  }
+  else if(mode == MODE_LOADING) { draw_loading(); }
+  else if(mode == MODE_BOARD) {
+    // a frame period or more late --> a frame was skipped
+    unsigned long now = hal_millis();
+    if(mode_drawn && now - frame_ms >= 2 * MILLIS_PER_FRAME) { PROBE_INC(PROBE_OVERRUNS); }
+    frame_ms = now;
+
+    if(help.busy) { find_hint(); } // may move the cursor to the hint
+
+    if(!mode_drawn && pick_timed) {
+      pregen_first_frame(hal_millis() - pick_ms);
+      pick_timed = false;
     }
+    if( !mode_drawn || (g_joyX != g_cursorX) || (g_joyY != g_cursorY) ) { updateCursor_board(); }
+    else { draw_board(); } // squares that changed
+  }
+  else if(mode == MODE_ERROR) {
+    if(!mode_drawn) { draw_result_error(); }
+    else if(old_selection != selected) { updateCursor_result(); }
+  }
+  else if(mode == MODE_DONE) {
+    if(!mode_drawn) { draw_result_completed(); }
+  }
+  mode_drawn = true;
+}
+
+// keeps the saved game up to date, see save.h
+void task_save() {
+  if(mode == MODE_BOARD || mode == MODE_ERROR) { store_game(); }
+}
 
-    delay(100);
+// one slice of puzzle generation: for the waiting player while loading,
+// else for the rings of pregen.h while the stick is left alone
+bool task_generate() {
+  if(mode == MODE_LOADING) {
+    // the pick was counted as a miss when it was made
+    if( pregen_take(selected, &soln) ) {
+      setup_grid();
+      set_mode(MODE_BOARD);
+    }
+    else { pregen_step(); }
+    return true;
   }
+
+  if(mode != MODE_MENU && mode != MODE_BOARD) { return false; }
+  if(hal_millis() - joy_last_used < MILLIS_REST) { return false; }
+  return pregen_step();
 }
 
 void draw_menu() {
     // fill screen with black
-    tft.fillScreen(0x0000);
+    hal_fill_screen(0x0000);
+    render_invalidate_all();
 
     // title
-    tft.setTextSize(3);
-    tft.setTextColor(0xFFFF,0x0000);
-    tft.setCursor(12, 21);
-    tft.print("SUDOKU");
+    hal_text(12, 21, 3, 0xFFFF, 0x0000, "SUDOKU");
 
     // list difficulty levels
-    tft.setTextSize(1);
-    tft.setTextColor(0xFFFF,0x0000);
-    tft.setCursor(28, 60); // 60 * i*14, i == [0,2]
-    tft.print("BEGINNER");
-    tft.setCursor(28, 74);
-    tft.print("INTERMEDIATE");
-    tft.setCursor(28, 88);
-    tft.print("HARD");
+    hal_text(28, 60, 1, 0xFFFF, 0x0000, "BEGINNER"); // 60 * i*14, i == [0,2]
+    hal_text(28, 74, 1, 0xFFFF, 0x0000, "INTERMEDIATE");
+    hal_text(28, 88, 1, 0xFFFF, 0x0000, "HARD");
+    if(save_ok) { hal_text(28, 102, 1, 0xFFFF, 0x0000, "CONTINUE"); }
 
     // initial cursor
-    tft.drawRect( 28 - 3, (selected * 14) + 60 - 3, 80, 14, RED );
+    hal_draw_rect( 28 - 3, (selected * 14) + 60 - 3, 80, 14, RED );
 }
 
-void scanJoystick_menu() {
-  int vert = analogRead(JOY_VERT_ANALOG);
-  // check joystick
-  if( abs(vert - JOY_VERT_CENTRE) > JOY_DEADZONE ) {
-    // if joystick points down
-    if(vert - JOY_VERT_CENTRE > 0) {
-      selected = constrain( selected + 1, 0, 2 );
+// opening screen. choosed difficulty
+void scanJoystick_menu( int dy, bool press ) {
+  // joystick points down (1) or up (-1)
+  if(dy != 0) { selected = constrain( selected + dy, 0, save_ok ? 3 : 2 ); }
+
+  if(press && selected == 3) {
+    if( resume_game() ) { set_mode(MODE_BOARD); }
+    return;
+  }
+
+  // button press --> take a ready puzzle, or wait for one
+  if(press) {
+    level = selected;
+
+    pick_ms = hal_millis();
+    pick_timed = true;
+    if( pregen_pop(selected, &soln) ) {
+      setup_grid();
+      set_mode(MODE_BOARD);
+      return;
     }
-    // if joystick points up
-    else if(vert - JOY_VERT_CENTRE < 0) {
-      selected = constrain( selected - 1, 0, 2 );
+
+    // none ready --> one from the bank, one seek and read
+    if( bank_ok && load_from_bank(selected) ) {
+      setup_grid();
+      set_mode(MODE_BOARD);
+      return;
     }
-  }
 
-  // update cursor and old_selection
-  if(old_selection != selected) { updateCursor_menu(); }
+    // made by task_generate(), before anything else
+    pregen_rush(selected);
+    set_mode(MODE_LOADING);
+  }
 }
 
 void updateCursor_menu() {
   // draw over old_selection
-  tft.drawRect( 28 - 3, (old_selection * 14) + 60 - 3, 80, 14, 0x0000 );
+  hal_draw_rect( 28 - 3, (old_selection * 14) + 60 - 3, 80, 14, 0x0000 );
   // draw new selected
-  tft.drawRect( 28 - 3, (selected * 14) + 60 - 3, 80, 14, RED );
+  hal_draw_rect( 28 - 3, (selected * 14) + 60 - 3, 80, 14, RED );
 
   // update old_selection
   old_selection = selected;
 }
 
-void mode_board() {
-  // reset cursor to top left square
-  g_joyX = 0;
-  g_cursorX = g_joyX;
-  g_joyY = 0;
-  g_cursorY = g_joyY;
-
-  // display generated sudoku
-  draw_board();
-
-  int prevTime = millis();
-  int t = 0;
-  // user can now try to solve the puzzle
-  while(true) {
-    scanJoystick_board();
-
-    if( digitalRead(JOY_SEL) == LOW ) {
-      if(g_joyY == 9) { break; } // either QUIT or VERIFY
-      else { update_grid(); } // update number in grid
-    }
-
-    t = millis();
-    if( 100 > (t - prevTime) ) { delay( 100 - (t - prevTime) ); }
-    prevTime = millis();
+// "Loading..." under the menu with a progress bar
+void draw_loading() {
+  if(!mode_drawn) {
+    // feedback
+    hal_text(28, 120, 1, 0xFFFF, 0x0000, "PRESS: CANCEL");
+    hal_text(28, 140, 1, 0xFFFF, 0x0000, "Loading...");
+    hal_draw_rect(28, 150, 74, 6, 0xFFFF);
   }
 
-  if(g_joyX == 1) { mode_result(); } // VERIFY
-  // if QUIT, do nothing
+  // bar grows with the squares stroke out
+  int w = pregen_progress(selected, 72);
+  if(w == shown_progress) { return; }
+  if(w > 0) { hal_fill_rect(29, 151, w, 4, 0xFFFF); }
+  shown_progress = w;
 }
 
-void draw_board() {
-  // fill screen with black
-  tft.fillScreen(0x0000);
-
-  for (int irow = 0; irow < 9; irow++) {
-    for (int icol = 0; icol < 9; icol++) {
-      // draw square
-      tft.drawRect(icol*14, irow*14, 14, 14, 0xFFFF);
-
-      char ch = grid[irow][icol].value + '0'; //take numbers from generate_grid
-                                              //and display them on grid
-      if(ch == '0') { tft.drawChar(icol*14 + 5, irow*14 + 4, ' ', 0xFFFF, 0x0000, 1); }
-      else if(grid[irow][icol].fixed == false) { tft.drawChar(icol*14 + 5, irow*14 + 4, ch, 0xFFFF, 0x0000, 1); }
-      else{ tft.drawChar(icol*14 + 5, irow*14 + 4, ch, RED, 0x0000, 1); }
-    }
-  }
+// button press --> back to the menu
+// the puzzle is still made in the background for next time
+void scanJoystick_loading( bool press ) {
+  if(!press) { return; }
+  pick_timed = false;
+  set_mode(MODE_MENU);
+}
 
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 3; j++) {
-      tft.drawRect(i*42.6, j*42.6, 44, 44, 0xFFFF);
-      tft.drawRect(i*42.6, j*42.6, 41, 41, 0xFFFF);
-    }
-  }
+// draws whatever changed since the last call, see render.h
+void draw_board() {
+  PROBE_START(frame);
+  render_board(&grid, pencil.mask, live.conflict, hint_shown(&help) ? help.why.cells : NULL,
+               pen, g_joyX, g_joyY);
+  PROBE_STOP(PROBE_REDRAW, frame);
+}
 
-  tft.fillRect(0, 126, 128, 34, 0x0000);
-  tft.fillRect(126, 0, 2, 126, 0x0000);
-  tft.fillRect(0, 126, 56, 33, 0x0000);
-  tft.fillRect(56, 126 , 56, 33, 0x0000);
-
-  // two buttons
-  tft.drawRect(0*42, 126, 42, 33, 0xFFFF);
-  tft.drawRect(1*42, 126, 42, 33, 0xFFFF);
-  tft.drawRect(2*42, 126, 42, 33, 0xFFFF);
-  tft.setTextColor(0xFFFF,0x0000);
-  tft.setTextSize(1);
-  tft.setCursor(10, 138);
-  tft.print("QUIT");
-  tft.setCursor(45, 138);
-  tft.print("VERIFY");
+// user can now try to solve the puzzle
+void scanJoystick_board( int dx, int dy, bool press ) {
+  // joystick points down (1) or up (-1)
+  if(dy != 0) { g_joyY = constrain( g_joyY + dy, 0, 10 ); }
 
-  // initial cursor
-  tft.drawRect( g_joyX*14, g_joyY*14, 14, 14, RED );
-}
+  // 2 rows of 3 buttons at the bottom
+  int last_x = (g_joyY >= 9) ? 2 : 8;
+  if(g_joyX > last_x) { g_joyX = last_x; }
 
-void scanJoystick_board() {
-  int vert = analogRead(JOY_VERT_ANALOG);
-  // check joystick
-  if( abs(vert - JOY_VERT_CENTRE) > JOY_DEADZONE ) {
-    // if joystick points down
-    if(vert - JOY_VERT_CENTRE > 0) {
-      g_joyY = constrain( g_joyY + 1, 0, 9 );
-    }
-    // if joystick points up
-    else if(vert - JOY_VERT_CENTRE < 0) {
-      g_joyY = constrain( g_joyY - 1, 0, 9 );
-    }
+  // joystick points right (1) or left (-1)
+  if(dx != 0) {
+    g_joyX = constrain( g_joyX + dx, 0, last_x );
   }
 
-  if(g_joyY == 9 && g_joyX > 1) { g_joyX = 1; }
-
-  int horz = analogRead(JOY_HORZ_ANALOG);
-  // check joystick
-  if( abs(horz - JOY_HORZ_CENTRE) > JOY_DEADZONE ) {
-    // if joystick points right
-    if( (g_cursorY == 9) && (horz - JOY_HORZ_CENTRE > 0) ) {
-      g_joyX = 1;
-    }
-    else if(horz - JOY_HORZ_CENTRE > 0) {
-      g_joyX = constrain( g_joyX + 1, 0, 8 );
-    }
-    // if joystick points left
-    else if( (g_cursorY == 9) && (horz - JOY_HORZ_CENTRE < 0) ) {
-      g_joyX = 0;
-    }
-    else if(horz - JOY_HORZ_CENTRE < 0) {
-      g_joyX = constrain( g_joyX - 1, 0, 8 );
-    }
+  if(!press) { return; }
+  if(g_joyY < 9) { // update number or notes in grid
+    if(pen) { update_notes(); }
+    else { update_grid(); }
+    return;
   }
 
-  if( (g_joyX != g_cursorX) || (g_joyY != g_cursorY) ) { updateCursor_board(); }
+  // QUIT, VERIFY, HINT, then NOTE, undo or redo
+  int button = (g_joyY - 9) * 3 + g_joyX;
+  if(button == 0) { set_mode(MODE_MENU); }
+  else if(button == 2) { hint_start(&help); }
+  else if(button == 3) { pen = (pen + 1) % 10; } // next value, then off
+  else if(button == 4) { undo_move(false); }
+  else if(button == 5) { undo_move(true); }
+  else if( test_soln() ) { set_mode(MODE_DONE); }
+  else { set_mode(MODE_ERROR); }
 }
 
 void updateCursor_board() {
-  // draw over old cursor
-  if(g_cursorY == 9) { tft.drawRect( g_cursorX*42, g_cursorY*14, 42, 33, 0xFFFF ); }
-  else { tft.drawRect( g_cursorX*14, g_cursorY*14, 14, 14, 0xFFFF ); }
-
-  // draw new cursor
-  if(g_joyY == 9) { tft.drawRect( g_joyX*42, g_joyY*14, 42, 33, RED ); }
-  else { tft.drawRect( g_joyX*14, g_joyY*14, 14, 14, RED ); }
+  // redraws the old and new cursor
+  draw_board();
 
   // update cursor values
   g_cursorX = g_joyX;
@@ -365,466 +446,227 @@ void updateCursor_board() {
 // y-coordinate == row
 // x-coordinate == col
 void update_grid() {
+  uint8_t idx = g_joyY*9 + g_joyX;
+
   // if num cannot be changed
-  if(grid[g_cursorY][g_cursorX].fixed == true) { return; }
+  if( board_is_fixed(&grid, idx) ) { return; }
 
   // "increment" num
-  int num = grid[g_cursorY][g_cursorX].value;
+  int num = board_get(&grid, idx);
   num++;
   if(num > 9) { num = 0; }
-  grid[g_cursorY][g_cursorX].value = num;
-
-  // draw new num
-  char ch = num + '0';
-  if(ch == '0') { tft.drawChar(g_cursorX*14 + 5, g_cursorY*14 + 4, ' ' , 0xFFFF, 0x0000, 1); }
-  else{ tft.drawChar(g_cursorX*14 + 5, g_cursorY*14 + 4, ch , 0xFFFF, 0x0000, 1); }
-}
+  journal_record(&moves, idx, board_get(&grid, idx), num);
+  set_square(idx, num);
 
-void mode_result() {
-  // if soln is correct
-  if( test_soln() ) {
-    draw_result_completed();
+  // last square filled without a clash --> no need to VERIFY
+  if( check_complete(&live) ) { set_mode(MODE_DONE); }
 
-    delay(3*1000);
-    return;
-  }
-
-  // if soln is wrong
-  selected = 0;
-  old_selection = selected;
+  // new num, and the squares that clash with it or stopped clashing,
+  // are drawn by the next task_draw()
+}
 
-  draw_result_error();
+// notes pen on the square under the cursor, or takes it off
+void update_notes() {
+  uint8_t idx = g_joyY*9 + g_joyX;
+  if( board_get(&grid, idx) ) { return; } // notes only show on empty squares
+  notes_toggle(&pencil, idx, pen);
+  save_dirty = true;
+}
 
-  while(true) {
-    scanJoystick_result();
+// n on square i of grid, with everything kept about grid
+void set_square( uint8_t i, uint8_t n ) {
+  check_set(&live, &grid, i, n);
+  hint_set(&help, i, n);
+  if(n) { notes_place(&pencil, i, n); } // off the 20 squares that see i
+  save_dirty = true;
+}
 
-    if( digitalRead(JOY_SEL) == LOW ) { break; }
+// one step towards the hint asked for. once there is one the cursor
+// goes to its square, the squares it follows from are outlined and
+// serial gets the technique and value
+void find_hint() {
+  PROBE_START(hint);
+  bool found = hint_step(&help, &soln);
+  PROBE_STOP(PROBE_HINT, hint);
+  if(!found) { return; }
 
-    delay(MILLIS_PER_FRAME);
-  }
+  uint8_t i = help.why.square;
+  g_joyX = i % 9;
+  g_joyY = i / 9;
 
-  if(selected == 0) { mode_board(); } // if user wants to retry
+  hal_serial_print("Hint: ");
+  hal_serial_print(hint_name(help.technique));
+  hal_serial_print(", ");
+  hal_serial_number(help.why.value);
+  hal_serial_print(" at row ");
+  hal_serial_number(g_joyY + 1);
+  hal_serial_print(" col ");
+  hal_serial_number(g_joyX + 1);
+  hal_serial_char('\n');
 }
 
 void draw_result_completed() {
-  tft.fillScreen(0x0000);
+  hal_fill_screen(0x0000);
+  render_invalidate_all();
 
-  tft.setTextSize(2);
-  tft.setTextColor(0xFFFF,0x0000);
-  tft.setCursor(6, 21);
-  tft.print("COMPLETED!");
+  hal_text(6, 21, 2, 0xFFFF, 0x0000, "COMPLETED!");
 }
 
 void draw_result_error() {
-  tft.fillScreen(0x0000);
+  // panel over the board. only the squares under it are redrawn on retry
+  hal_fill_rect(4, 14, 120, 77, 0x0000);
+  hal_draw_rect(4, 14, 120, 77, 0xFFFF);
+  render_invalidate(4, 14, 120, 77);
 
-  tft.setTextSize(3);
-  tft.setTextColor(0xFFFF,0x0000);
-  tft.setCursor(12, 21);
-  tft.print("ERROR!");
+  hal_text(12, 21, 3, 0xFFFF, 0x0000, "ERROR!");
 
-  tft.setTextSize(1);
-  tft.setTextColor(0xFFFF,0x0000);
-  tft.setCursor(28, 60);
-  tft.print("TRY AGAIN?");
+  hal_text(28, 60, 1, 0xFFFF, 0x0000, "TRY AGAIN?");
 
-  tft.setCursor(28, 74);
-  tft.print("YES /");
-  tft.setCursor(70, 74);
-  tft.print("NO");
+  hal_text(28, 74, 1, 0xFFFF, 0x0000, "YES /");
+  hal_text(70, 74, 1, 0xFFFF, 0x0000, "NO");
 
   // initial cursor
-  tft.drawRect( (selected * 42) + 28 - 3, 74 - 4, 28, 14, RED );
+  hal_draw_rect( (selected * 42) + 28 - 3, 74 - 4, 28, 14, RED );
 }
 
-void scanJoystick_result() {
-  // check joystick
-  int horz = analogRead(JOY_HORZ_ANALOG);
-  if( abs(horz - JOY_HORZ_CENTRE) > JOY_DEADZONE ) {
-    // if joystick points right
-    if(horz - JOY_HORZ_CENTRE > 0) {
-      selected = constrain( selected + 1, 0, 1 );
-    }
-    // if joystick points left
-    else if(horz - JOY_HORZ_CENTRE < 0) {
-      selected = constrain( selected - 1, 0, 1 );
-    }
-  }
+// soln is wrong: retry or back to the menu
+void scanJoystick_result( int dx, bool press ) {
+  // joystick points right (1) or left (-1)
+  if(dx != 0) { selected = constrain( selected + dx, 0, 1 ); }
 
-  // update cursor and old_selection
-  if(old_selection != selected) { updateCursor_result(); }
+  if(!press) { return; }
+  if(selected == 0) { set_mode(MODE_BOARD); } // if user wants to retry
+  else { set_mode(MODE_MENU); }
 }
 
 void updateCursor_result() {
   // draw over old_selection
-  tft.drawRect( (old_selection * 42) + 28 - 3, 74 - 4, 28, 14, 0x0000 );
+  hal_draw_rect( (old_selection * 42) + 28 - 3, 74 - 4, 28, 14, 0x0000 );
   // draw new selected
-  tft.drawRect( (selected * 42) + 28 - 3, 74 - 4, 28, 14, RED );
+  hal_draw_rect( (selected * 42) + 28 - 3, 74 - 4, 28, 14, RED );
 
   // update old_selection
   old_selection = selected;
 }
 
-// cleans out grid. sets to 0 and false
 void clear_grid() {
-  for(int i=0; i<9; ++i ) {   // 0 to 8
-    for(int j=0; j<9; ++j ) { // 0 to 8
-      grid[i][j].value = 0;
-      grid[i][j].fixed == false;
-    }
-  }
+  board_clear(&grid);
 }
 
-// clears any non fixed value on grid
-void empty_grid() {
-  for(int i=0; i<9; ++i ) {   // 0 to 8
-    for(int j=0; j<9; ++j ) { // 0 to 8
-      if( grid[i][j].fixed == false ) { grid[i][j].value = 0; }
-    }
-  }
-}
+// random seed / God
+// takes about 320ms on the Mega, so it is only called once by setup()
+uint32_t RNGesus() {
+  uint32_t val = 0;
+  uint32_t result = 0;
+  PROBE_INC(PROBE_RNGESUS);
 
-// generates vanilla sudoku:
-//   1,2,3,4,5,6,7,8,9
-//   4,5,6,7,8,9,1,2,3
-//   7,8,9,1,2,3,4,5,6
-//   2,3,4,5,6,7,8,9,1
-//   5,6,7,8,9,1,2,3,4
-//   8,9,1,2,3,4,5,6,7
-//   3,4,5,6,7,8,9,1,2
-//   6,7,8,9,1,2,3,4,5
-//   9,1,2,3,4,5,6,7,8
-// then transforms it to make a new puzzle
-// also prints soln on serial-monitor
-void generate_grid() {
-  int n=1; // starting value of every row
-  int k=1; // current value
-  for( int i=0; i<9; ++i ) { // row index: 0 to 8
-    k = n; // set current value to starting value
-    for( int j=0; j<9; ++j ) { // col index: 0 to 8
-      // assign value and fix
-      grid[i][j].value = k;
-      grid[i][j].fixed = true;
-
-      //next value
-      k++;
-      if(k > 9) { k = 1; } // values: 1 to 9. wraparound
-    }
-
-    // notice that each row starts with last num from prev row + 4
-    // note: last num from prev row is already incremented by 1
-    n = k + 3;
-    if(n > 9) { n = (n%9) + 1; } // 6 --> 2, 7 --> 3
+  for( int i=0; i<32; i++ ) { // get bit 32 times to get 32 bits
+    val = hal_noise();            // one noisy bit
+    result = (result << 1) + val; // shift key_val left before adding new bit
   }
 
-  // certain transformations on a complete sudoku yields
-  // a still complete sudoku
-  random_gen_swap(0);
-  random_gen_swap(1);
-  random_gen_change(0);
-  random_gen_change(1);
+  return result; // returns 32-bit seed
+}
 
-  // copy soln onto soln_grid[][]
-  for(int i=0; i<9; ++i ) {   // 0 to 8
-    for(int j=0; j<9; ++j ) { // 0 to 8
-      soln_grid[i][j].value = grid[i][j].value;
-      soln_grid[i][j].fixed = true;
-    }
-  }
+// reads the index of the puzzle bank (see bank.h)
+bool open_bank() {
+  uint8_t bytes[BANK_HEADER];
+  if( !hal_sd_open(BANK_FILE) ) { return false; }
+  if( !hal_sd_read(0, bytes, BANK_HEADER) || !bank_read_header(bytes, &bank) ) { return false; }
 
-  // print soln_grid on serial-monitor
-  print_grid();
+  uint32_t n = 0;
+  for( int l=0; l<BANK_LEVELS; ++l ) { n += bank_count(&bank, l); }
+  hal_serial_print("Puzzle bank: ");
+  hal_serial_number(n);
+  hal_serial_print(" puzzles\n");
+  return true;
 }
 
-// swaps row or col in a three group
-void random_gen_swap(int check) {
-  int k1, k2;
-   //There are three groups.So we are using for loop three times.
-   for( int i=0; i<3; i++ ) {
-     // pick random row or col
-      k1 = i*3 + RNGesus() % 3;
-      k2 = i*3 + RNGesus() % 3;
-      //This while is just to ensure k1 is not equal to k2.
-      while(k1 == k2) { k2 = i*3 + RNGesus() % 3; }
-
-      //check is global variable.
-      //We are calling random_gen two time from the main func.
-      //Once it will be called for columns and once for rows.
-      if     (check == 0) { row_swap(k1,k2); } //calling a function to interchange the selected rows.
-      else if(check == 1) { col_swap(k1,k2); }
-   }
-}
-
-// for row
-void row_swap(int k1, int k2) {
-    uint8_t temp;
-    for( int j=0; j<9; j++ ) {
-       temp = grid[k1][j].value;
-       grid[k1][j].value = grid[k2][j].value;
-       grid[k2][j].value = temp;
-    }
- }
-
-// for col
-void col_swap(int k1,int k2) {
-  uint8_t temp;
-   for(int i=0;i<9;i++) {
-      temp=grid[i][k1].value;
-      grid[i][k1].value=grid[i][k2].value;
-      grid[i][k2].value=temp;
-   }
-}
-
-// swaps row or col groups of three
-void random_gen_change(int check) {
-  int k1, k2;
-    k1 = RNGesus() % 3;
-    k2 = RNGesus() % 3;
-    while(k1 == k2) { k2 = RNGesus() % 3; }
-
-    // indices: 0,1,2 --> 0,3,6
-    k1 = k1 * 3;
-    k2 = k2 * 3;
-
-    //check is global variable.
-    //We are calling random_gen two time from the main func.
-    //Once it will be called for columns and once for rows.
-    if     (check == 0) { row_change(k1,k2); } //calling a function to interchange the selected rows.
-    else if(check == 1) { col_change(k1,k2); }
-}
-
-// for row group
-void row_change(int k1,int k2) {
-   uint8_t temp;
-   for(int n=1;n<=3;n++) {
-      for(int j=0;j<9;j++) {
-         temp=grid[k1][j].value;
-         grid[k1][j].value=grid[k2][j].value;
-         grid[k2][j].value=temp;
-      }
-
-      k1++;
-      k2++;
-   }
-}
-
-// for col group
-void col_change(int k1,int k2) {
-   uint8_t temp;
-   for(int n=1;n<=3;n++) {
-      for(int i=0;i<9;i++) {
-         temp=grid[i][k1].value;
-         grid[i][k1].value=grid[i][k2].value;
-         grid[i][k2].value=temp;
-      }
-
-      k1++;
-      k2++;
-   }
-}
-
-// solves sudoku using bruteforce, backtracking and recursion
-// false --> sudoku has no soln
-// true ---> sudoku has a soln
-bool solve_grid( int row, int col ) {
-  // look for next non fixed value
-	while(grid[row][col].fixed == true) {
-	  col++;
-	  if(col > 8) {
-	  	col = 0;
-		  row++;
-	  }
-    // sudoku is solved if all squares have assigned valid n
-	  if(row > 8) { return true; }
-	}
-
-	// insert 1 to 9 into non fixed square and see if it forms a soln
-  for ( int n=1; n<10; ++n ) {
-    // plug in n
-		grid[row][col].value = n;
-    // test if n is valid
-		if( test_col( row, col ) && test_row( row, col ) && test_box( row, col ) ) {
-			// go to next square
-      int next_row = row;
-			int next_col = col + 1;
-			if(next_col > 8) {
-			  next_col = 0;
-			  next_row++;
-			}
-
-      // sudoku is solved if all squares have assigned valid n
-			if(next_row > 8) { return true;	}
-      // recurse
-			if( solve_grid( next_row, next_col) ) { return true; }
-		}
-  }
-  // sudoku has no soln if no n is valid
-	grid[row][col].value = 0;
-	return false;
-}
-
-// check if value is already on row
-bool test_row( int row, int col ) {
-	for( int j=0; j<9; ++j ) {
-		if(j != col) {
-			if( grid[row][j].value == grid[row][col].value ) { return false; }
-		}
-	}
-	return true;
-}
-
-// check if value is already on col
-bool test_col( int row, int col ) {
-  for( int i=0; i<9; ++i ) {
-		if(i != row) {
-			if( grid[i][col].value == grid[row][col].value ) { return false; }
-		}
-	}
-	return true;
-}
-
-// check if value is already on box
-bool test_box( int row, int col ){
-	int irow = (row / 3) * 3;
-	int icol = (col / 3) * 3;
-
-  for( int i=irow; i<irow + 3; ++i ) {
-		for( int j=icol; j<icol + 3; ++j ) {
-			if( (i != row) && (j != col) ) {
-				if( grid[i][j].value == grid[row][col].value ) { return false; }
-			}
-		}
-	}
-	return true;
-}
-
-// random number generator / God
-int RNGesus() {
-  int analogPin = 7; // analog pin 7 should not be connected to anything
-  int val = 0;
-  int result = 0;
-
-  for( int i=0; i<4; i++ ) { // get bit 4 times to get 4 bits
-    val = analogRead(analogPin);  //analog pin 7 voltage fluctuates
-    val = val & 1;                // remainder is least significant bit
-    result = (result << 1) + val; // shift key_val left before adding new bit
-    delay(10); // wait for 10ms to allow for voltage fluctuation
-  }
+// random puzzle of level from the bank into soln
+// false --> none of that level, or the card failed
+bool load_from_bank( int level ) {
+  uint32_t record;
+  if( !bank_pick(&bank, level, &gen.rng, &record) ) { return false; }
 
-  return result; // returns 4-bit num [0-15]
-}
-
-// strikes out squares while maintaining uniqueness
-void reduce_grid() {
-  for(int i=0; i<difficulty; ++i ) { // number of values to strike out
-    // pick random square
-    num_row = RNGesus() % 9; // 0 to 8
-    num_col = RNGesus() % 9; // 0 to 8
-
-    // store value before striking out
-    num_val = grid[num_row][num_col].value;
-    // strike out selected square
-    grid[num_row][num_col].value = 0;
-    grid[num_row][num_col].fixed = false;
-
-    // do again if square is already stroke out
-    //          or soln is no longer unique
-    while( num_val==0 || test_unique(0,0) ) {
-      // restore square only if its not already stroke out
-      if(num_val != 0) {
-        grid[num_row][num_col].value = num_val;
-        grid[num_row][num_col].fixed = true;
-      }
-
-      // find next square to try to strike out
-      num_col++;
-      if(num_col > 8) {
-        num_col = 0;
-        num_row++;
-      }
-      if(num_row > 8) { num_row = 0; }
-
-      // store value then strike out again
-      num_val = grid[num_row][num_col].value;
-      grid[num_row][num_col].value = 0;
-      grid[num_row][num_col].fixed = false;
-    }
-  }
-  // clean up to prevent bugs
-  empty_grid();
-}
-
-// based on solver
-// true ---> another soln exists
-// false --> no other soln exists i.e. solution is unique
-bool test_unique( int row, int col ) {
-	while(grid[row][col].fixed == true) {
-	  col++;
-	  if(col > 8) {
-	  	col = 0;
-		  row++;
-	  }
-	  if(row > 8) { return true; }
-	}
-
-	for ( int n=1; n<10; ++n ) {
-    // excludes value removed to check for other possible soln
-    if( row==num_row && col==num_col && n==num_val ) { continue; }
-
-		grid[row][col].value = n;
-		if( test_col( row, col ) && test_row( row, col ) && test_box( row, col ) ) {
-			int next_row = row;
-			int next_col = col + 1;
-
-			if(next_col > 8) {
-			  next_col = 0;
-			  next_row++;
-			}
-			if(next_row > 8) { return true;	}
-      // recurse
-			if( test_unique( next_row, next_col ) ) { return true; }
-    }
-  }
-	grid[row][col].value = 0;
-	return false;
+  uint8_t bytes[BANK_RECORD];
+  if( !hal_sd_read(bank_offset(record), bytes, BANK_RECORD) ) { return false; }
+  bank_read_record(bytes, &soln);
+  return true;
 }
 
+// soln was taken off a ring of pregen.h or out of the bank
 void setup_grid() {
-  // generate random sudoku
-  generate_grid();
-  reduce_grid();
-  // make sure sudoku is complete and unique
-  while( !solve_grid(0,0) ) { reduce_grid(); }
-  empty_grid();
+  // print soln on serial-monitor
+  print_grid();
+
+  // givens of soln onto grid. stroke out squares are not fixed
+  uint8_t cells[81];
+  board_givens(&soln, cells);
+  board_load(&grid, cells);
+  check_load(&live, &grid);
+  hint_load(&help, &grid);
+  notes_clear(&pencil);
+  pen = 0;
+  journal_clear(&moves);
+  save_dirty = true;
+}
+
+// takes back the last move, or makes the last undone move again
+void undo_move( bool redo ) {
+  uint16_t d;
+  if( !(redo ? journal_redo(&moves, &d) : journal_undo(&moves, &d)) ) { return; }
+  uint8_t n = redo ? journal_new(d) : journal_old(d);
+  set_square(journal_square(d), n);
+
+  // a redo can fill the last square
+  if( check_complete(&live) ) { set_mode(MODE_DONE); }
+}
+
+// snapshot of the game into the save area, if it changed
+void store_game() {
+  if(!save_dirty) { return; }
+  save_game s = { (uint8_t)level, &grid, &soln, &pencil };
+  save_ok = save_store(&s);
+  save_dirty = false;
+}
+
+// the saved game back onto the board, with no undo history
+// false --> no game saved
+bool resume_game() {
+  save_game s = { 0, &grid, &soln, &pencil };
+  if( !save_load(&s) ) { return false; }
+  level = s.level;
+  pen = 0;
+  check_load(&live, &grid);
+  hint_load(&help, &grid);
+  journal_clear(&moves);
+  save_dirty = false;
+  save_ok = true;
+  print_grid();
+  return true;
 }
 
 // prints solution grid on serial monitor for verification
 void print_grid() {
   for(int i=0; i<9; ++i ) {   // 0 to 8
     for(int j=0; j<9; ++j ) { // 0 to 8
-      char ch = soln_grid[i][j].value + '0'; // index = ith row, jth column
+      char ch = board_get(&soln, i*9 + j) + '0'; // index = ith row, jth column
 
-      if( ch == '0' ) { Serial.print(" "); } // 0 is not a valid input in sudoku
-      else { Serial.print(ch); }
+      if( ch == '0' ) { hal_serial_char(' '); } // 0 is not a valid input in sudoku
+      else { hal_serial_char(ch); }
 
-      if(j == 8) { Serial.println(); } // newline
-      else { Serial.print(","); }      // comma separate
+      if(j == 8) { hal_serial_char('\n'); } // newline
+      else { hal_serial_char(','); }       // comma separate
     }
   }
-  Serial.println();
+  hal_serial_char('\n');
 }
 
 // check if player input is correct
 // false --> soln is wrong
 // true ---> soln is correct
 bool test_soln() {
-  // go through 9x9 grid
-  for(int i=0; i<9; ++i ) {   // 0 to 8
-    for(int j=0; j<9; ++j ) { // 0 to 8
-      // if any value doesn't match, solution is wrong
-      if( soln_grid[i][j].value != grid[i][j].value ) { return false; }
-    }
-  }
-  // else, solution is correct
-  return true;
+  // values are packed the same way, so compare all 81 at once
+  // if any value doesn't match, solution is wrong
+  return memcmp(grid.value, soln.value, sizeof(grid.value)) == 0;
 }